@@ -27,6 +27,7 @@ AnechoicControls::AnechoicControls (AnechoicProcessor& processor,
   , mParameters (params)
   , buttonAttachment (params, "HRTF", hrtfMenu)
   , distanceAttenuationLabel("Distance Label", "dB attenuation per double distance")
+  , levelMeter (processor.getLevelMeter())
 {
   setOpaque (true);
     
@@ -78,6 +79,8 @@ AnechoicControls::AnechoicControls (AnechoicProcessor& processor,
   distanceAttenuationSlider.addListener( this );
   addAndMakeVisible( distanceAttenuationSlider );
   
+  addAndMakeVisible( levelMeter );
+  
   updateGui();
   updateHrtfLabelText();
     
@@ -108,6 +111,8 @@ void AnechoicControls::updateGui() {
   nearFieldToggle.setToggleState( mCore.enableNearDistanceEffect, dontSendNotification);
   farFieldToggle.setToggleState( mCore.enableFarDistanceEffect, dontSendNotification);
   qualityToggle.setToggleState( mCore.spatializationMode, dontSendNotification);
+  
+  levelMeter.updateGui();
 }
 
 void AnechoicControls::paint (Graphics& g)
@@ -131,6 +136,7 @@ void AnechoicControls::resized() {
   distanceAttenuationToggle.setBounds( 10, farFieldToggle.getBottom() + 4, 80, 24);
   distanceAttenuationLabel.setBounds( 94, distanceAttenuationToggle.getY(), area.getWidth()-100, 24);
   distanceAttenuationSlider.setBounds( 6, distanceAttenuationToggle.getBottom() + 4, area.getWidth()-20, 24);
+  levelMeter.setBounds( 12, distanceAttenuationSlider.getBottom() + 1, area.getWidth()-24, 10);
 }
 
 void AnechoicControls::sliderValueChanged (Slider* slider)
@@ -154,6 +160,7 @@ void AnechoicControls::updateBypass() {
   } else {
     mCore.getSources().front()->DisableAnechoicProcess();
   }
+  mCore.sourceChanged();
   setAlpha( enabled + 0.4f );
 }
 
@@ -22,6 +22,7 @@
 
 #include <JuceHeader.h>
 #include "SpatialisePluginProcessor.h"
+#include "Common/LevelMeter.h"
 
 //==============================================================================
 /*
@@ -74,5 +75,7 @@ private:
   Label distanceAttenuationLabel;
   Slider distanceAttenuationSlider;
   
+  LevelMeterComponent levelMeter;
+  
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnechoicControls)
 };
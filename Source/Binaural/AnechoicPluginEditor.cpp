@@ -30,6 +30,8 @@ AnechoicPluginProcessorEditor::AnechoicPluginProcessorEditor (AnechoicPluginProc
   ,  anechoicControls (p.getCore(), p.treeState)
   ,  reverbControls (p)
   ,  spatializerWidget (p.getCore())
+  ,  outputMeter (p.getOutputMeter())
+  ,  refreshScheduler (*this, [this] { updateGui(); })
 {
     setOpaque (true);
     
@@ -52,16 +54,14 @@ AnechoicPluginProcessorEditor::AnechoicPluginProcessorEditor (AnechoicPluginProc
     addAndMakeVisible (anechoicControls);
     addAndMakeVisible (reverbControls);
     addAndMakeVisible (spatializerWidget);
+    addAndMakeVisible (outputMeter);
     addChildComponent (aboutText);
 
     setSize (900, 726);
-    
-    startTimerHz (30);
 }
 
 AnechoicPluginProcessorEditor::~AnechoicPluginProcessorEditor()
 {
-   stopTimer();
 }
 
 //==============================================================================
@@ -90,6 +90,7 @@ void AnechoicPluginProcessorEditor::resized()
     anechoicControls.setBounds (controlsBounds.removeFromTop (252));
     sourceControls.setBounds (controlsBounds.removeFromTop (324));
     reverbControls.setBounds (controlsBounds);
+    outputMeter.setBounds (r.removeFromBottom (16).reduced (12, 2));
     spatializerWidget.setBounds (r);
 
     aboutText.setBounds(r);
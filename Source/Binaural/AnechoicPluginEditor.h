@@ -22,6 +22,7 @@
 
 #include <JuceHeader.h>
 #include "Common/AboutBanner.h"
+#include "Common/RefreshScheduler.h"
 #include "AnechoicControls.h"
 #include "SourceControls.h"
 #include "SourceReverbControls.h"
@@ -32,7 +33,7 @@
 //==============================================================================
 /**
 */
-class AnechoicPluginProcessorEditor : public AudioProcessorEditor, public Timer
+class AnechoicPluginProcessorEditor : public AudioProcessorEditor
 {
 public:
   AnechoicPluginProcessorEditor (AnechoicPluginProcessor&);
@@ -43,12 +44,13 @@ public:
   void paintOverChildren (Graphics& g) override;
   void resized() override;
   
-  void timerCallback() override
+  void updateGui()
   {
     anechoicControls.updateGui();
     sourceControls.updateGui();
     spatializerWidget.updateGui();
     reverbControls.updateGui();
+    outputMeter.updateGui();
 
     bool anechoicEnabled = anechoicControls.bypassToggle.getToggleState();
     anechoicControls.setAlpha(anechoicEnabled + 0.4f);
@@ -69,10 +71,13 @@ private:
   AnechoicControls anechoicControls;
   ReverbControls reverbControls;
   SpatializerWidget spatializerWidget;
+  LevelMeterComponent outputMeter;
 
   TextEditor aboutText;
   Label pluginVersionLabel;
   Label toolkitVersionLabel;
 
+  RefreshScheduler refreshScheduler;
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnechoicPluginProcessorEditor)
 };
@@ -18,11 +18,15 @@
 * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
 */
 
+#include "Common/PluginState.h"
 #include "AnechoicPluginProcessor.h"
 #include "AnechoicPluginEditor.h"
 
 static constexpr int kTOOLKIT_BUFFER_SIZE = 512; // TODO(Ragnar): Make variable
 
+// Each input channel is rendered as a virtual source, up to a 7.1 bed
+static constexpr int kMAX_INPUT_CHANNELS = 8;
+
 void addBooleanHostParameter(AudioProcessorValueTreeState& treeState, String name, int value)
 {
   const auto bypassValueToText = [](float value) {
@@ -53,58 +57,63 @@ AnechoicPluginProcessor::AnechoicPluginProcessor()
 {
     mSpatializer.addSoundSource (Common::CVector3(0,1,0));
     
-    auto position = getCore().getSourcePosition(0);
+    auto position = getCore().getSourcePosition();
   
     using Parameter = AudioProcessorValueTreeState::Parameter;
     treeState.createAndAddParameter (std::make_unique<Parameter> ("Azimuth", "Azimuth", "", NormalisableRange<float> (-180.f, 180.f), position.GetAzimuthDegrees(), [](float value) { return String (value, 1); }, nullptr));
-    treeState.addParameterListener ("Azimuth", this);
     
     treeState.createAndAddParameter (std::make_unique<Parameter> ("Elevation", "Elevation", "", NormalisableRange<float>(-89.f, 89.f), position.GetElevationDegrees(), [](float value) { return String (value, 0); }, nullptr));
-    treeState.addParameterListener ("Elevation", this);
 
     treeState.createAndAddParameter (std::make_unique<Parameter> ("Distance", "Distance", "", NormalisableRange<float>(0.001f, 40.f), position.GetDistance(), [](float value) { return String (value, 2); }, nullptr));
-    treeState.addParameterListener ("Distance", this);
     
     treeState.createAndAddParameter (std::make_unique<Parameter> ("X", "X", "", NormalisableRange<float>(-40.f, 40.f), position.x, [](float value) { return String (value, 2); }, nullptr));
-    treeState.addParameterListener ("X", this);
     
     treeState.createAndAddParameter (std::make_unique<Parameter> ("Y", "Y", "", NormalisableRange<float>(-40.f, 40.f), position.y, [](float value) { return String (value, 2); }, nullptr));
-    treeState.addParameterListener ("Y", this);
     
     treeState.createAndAddParameter (std::make_unique<Parameter> ("Z", "Z", "", NormalisableRange<float>(-40.f, 40.f), position.z, [](float value) { return String (value, 2); }, nullptr));
-    treeState.addParameterListener ("Z", this);
     
     treeState.createAndAddParameter (std::make_unique<Parameter> ("Source Attenuation", "Src Attenuation", "", getCore().sourceDistanceAttenuation.range, getCore().sourceDistanceAttenuation.get(), nullptr, nullptr));
-    treeState.addParameterListener ("Source Attenuation", this);
     
     addBooleanHostParameter (treeState, "Enable Rev Dist Attenuation", getCore().enableReverbDistanceAttenuation.get());
-    treeState.addParameterListener ("Enable Rev Dist Attenuation", this);
     treeState.createAndAddParameter (std::make_unique<Parameter> ("Reverb Attenuation", "Rev Attenuation", "", getCore().reverbDistanceAttenuation.range, getCore().reverbDistanceAttenuation.get(), nullptr, nullptr));
-    treeState.addParameterListener ("Reverb Attenuation", this);
     
     addBooleanHostParameter(treeState, "Near Field", getCore().enableNearDistanceEffect);
-    treeState.addParameterListener ("Near Field", this);
     
     addBooleanHostParameter(treeState, "Far Field", getCore().enableFarDistanceEffect);
-    treeState.addParameterListener ("Far Field", this);
     
     addBooleanHostParameter(treeState, "Custom Head", getCore().enableCustomizedITD);
-    treeState.addParameterListener ("Custom Head", this);
     
     treeState.createAndAddParameter (std::make_unique<Parameter> ("Head Circumference", "Head Circumference", "", NormalisableRange<float>(getCore().headCircumference.getRange().getStart(), getCore().headCircumference.getRange().getEnd()), getCore().headCircumference.get(), [](float value) { return String (value, 0); }, nullptr));
-    treeState.addParameterListener ("Head Circumference", this);
     
     addBooleanHostParameter (treeState, "Enable Anechoic", true);
-    treeState.addParameterListener ("Enable Anechoic", this);
     
     addBooleanHostParameter (treeState, "Enable Reverb", true);
-    treeState.addParameterListener ("Enable Reverb", this);
     
     treeState.createAndAddParameter (std::make_unique<Parameter> ("HRTF", "HRTF", "", NormalisableRange<float>(0, BundledHRTFs.size()-1), 0, [](float value) { return String (value, 0); }, nullptr));
     treeState.addParameterListener ("HRTF", &mSpatializer);
+    
+    treeState.createAndAddParameter (std::make_unique<Parameter> ("Head Yaw", "Head Yaw", "", getCore().listenerYaw.range, getCore().listenerYaw.get(), [](float value) { return String (value, 1); }, nullptr));
+    
+    treeState.createAndAddParameter (std::make_unique<Parameter> ("Head Pitch", "Head Pitch", "", getCore().listenerPitch.range, getCore().listenerPitch.get(), [](float value) { return String (value, 1); }, nullptr));
+    
+    treeState.createAndAddParameter (std::make_unique<Parameter> ("Head Roll", "Head Roll", "", getCore().listenerRoll.range, getCore().listenerRoll.get(), [](float value) { return String (value, 1); }, nullptr));
+    
+    addBooleanHostParameter (treeState, "Head Tracking", getCore().enableHeadTracking.get());
+    
+    treeState.createAndAddParameter (std::make_unique<Parameter> ("Stereo Spread", "Stereo Spread", "", getCore().stereoSpread.range, getCore().stereoSpread.get(), [](float value) { return String (value, 0); }, nullptr));
+    
+    // Changes are dispatched by parameter index, which is the creation order
+    jassert (getParameters().size() == kNumParameters);
+    jassert (treeState.getParameter ("HRTF")->getParameterIndex() == kHRTF);
+    jassert (treeState.getParameter ("Head Tracking")->getParameterIndex() == kHeadTracking);
+    
+    for (auto* parameter : getParameters())
+        parameter->addListener (this);
   
     treeState.state = ValueTree("3DTI Anechoic Spatialisation Parameters");
     
+    setUpHostSync();
+    
 #if DEBUG
     ERRORHANDLER3DTI.SetVerbosityMode(VERBOSITYMODE_ERRORSANDWARNINGS);
     ERRORHANDLER3DTI.SetErrorLogStream(&std::cout, true);
@@ -180,12 +189,28 @@ void AnechoicPluginProcessor::prepareToPlay (double sampleRate, int samplesPerBl
 {
   const int blockSizeInternal = kTOOLKIT_BUFFER_SIZE;
     
+  // Resources only exist for some sample rates, sessions running
+  // at a multiple of one of those are processed at that rate
+  const double processingSampleRate = IntegerResampler::getProcessingSampleRate (sampleRate);
+  const int factor = roundToInt (sampleRate / processingSampleRate);
+  
+  const int numInputs = jmax (1, getTotalNumInputChannels());
+  
+  downsamplerMain.prepare (numInputs, factor);
+  upsamplerMain.prepare (2, factor);
+  upsamplerBuss.prepare (4, factor);
+  
+  downsampledMain.setSize (numInputs, samplesPerBlock);
+  blockInMain.setSize (numInputs, blockSizeInternal);
+  upsampledMain.setSize (2, blockSizeInternal * factor);
+  upsampledBuss.setSize (4, blockSizeInternal * factor);
+    
   // Set up anechoic buffers
   inFifoMain.clear();
-  inFifoMain.setSize (1, blockSizeInternal + 1);
+  inFifoMain.setSize (numInputs, blockSizeInternal + 1);
   
   outFifoMain.clear();
-  outFifoMain.setSize (2, std::max(samplesPerBlock, blockSizeInternal) * 2);
+  outFifoMain.setSize (2, std::max(samplesPerBlock, blockSizeInternal * factor) * 2);
    
   scratchBufferMain.setSize (2, blockSizeInternal);
     
@@ -194,14 +219,19 @@ void AnechoicPluginProcessor::prepareToPlay (double sampleRate, int samplesPerBl
   inFifoBuss.setSize (4, blockSizeInternal + 1);
     
   outFifoBuss.clear();
-  outFifoBuss.setSize (4, std::max (samplesPerBlock, blockSizeInternal) * 2);
+  outFifoBuss.setSize (4, std::max (samplesPerBlock, blockSizeInternal * factor) * 2);
     
   scratchBufferBuss.setSize (4, blockSizeInternal);
+  
+  setLatencySamples (downsamplerMain.getLatencySamples() + upsamplerMain.getLatencySamples());
    
   // Initalise 3dti toolkit
-  mCore.SetAudioState ({(int)sampleRate, blockSizeInternal});
+  mCore.SetAudioState ({(int)processingSampleRate, blockSizeInternal});
     
-  mSpatializer.setup (sampleRate/*,blockSizeInternal*/);
+  mSpatializer.setInputLayout (getChannelLayoutOfBus (true, 0));
+  mSpatializer.setup (processingSampleRate/*,blockSizeInternal*/);
+  
+  mOutputMeter.prepare (sampleRate, 2);
 }
 
 void AnechoicPluginProcessor::releaseResources() {
@@ -212,8 +242,13 @@ void AnechoicPluginProcessor::releaseResources() {
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool AnechoicPluginProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    if (layouts.getMainInputChannelSet() != AudioChannelSet::mono()
-     && layouts.getMainInputChannelSet() != AudioChannelSet::stereo())
+    auto input = layouts.getMainInputChannelSet();
+    
+    if (input.isDisabled() || input.size() > kMAX_INPUT_CHANNELS)
+        return false;
+    
+    // Every channel needs a place around the listener
+    if (! AnechoicProcessor::isInputLayoutSupported (input))
         return false;
     
     if (layouts.getMainOutputChannelSet() != AudioChannelSet::stereo())
@@ -236,46 +271,53 @@ void AnechoicPluginProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuff
     AudioSampleBuffer mainInput = getBusBuffer (buffer, true, 0);
     AudioSampleBuffer sideChain = getBusBuffer (buffer, false, 1);
     
-    AudioBuffer<float> tempMain (1, 1);
-
-    int numSamples  = mainInput.getNumSamples();
-    int numChannels = mainInput.getNumChannels();
+    int numSamples = mainInput.getNumSamples();
+    int numInputs  = downsampledMain.getNumChannels();
+    
+    jassert (mainInput.getNumChannels() >= numInputs);
+    
+    // Only reallocates if the host exceeds the block size it announced
+    downsampledMain.setSize (numInputs, numSamples, false, false, true);
+    
+    // Channels stay separate, each one feeds its own virtual source
+    int numDownsampled = downsamplerMain.downsample (mainInput, numSamples, downsampledMain);
     
     const int blockSizeInternal = kTOOLKIT_BUFFER_SIZE;
     // Some hosts send buffers of varying sizes so we maintain
     // an internal buffer to pass the correct size to the 3dti core
-    for (int sample = 0; sample < numSamples; ++sample)
+    for (int position = 0; position < numDownsampled;)
     {
-        tempMain.clear();
+        int numToAdd = std::min (inFifoMain.getFreeSpace(), numDownsampled - position);
         
-        // Sum to mono in 'temp'
-        for (int channel = 0; channel < numChannels; ++channel)
-            tempMain.addSample (0, 0, mainInput.getSample (channel, sample));
+        const float* samples[kMAX_INPUT_CHANNELS];
         
-        tempMain.applyGain (1.0f / (float)numChannels);
+        for (int channel = 0; channel < numInputs; ++channel)
+            samples[channel] = downsampledMain.getReadPointer (channel, position);
         
-        inFifoMain.addToFifo (tempMain);
+        inFifoMain.addToFifo (samples, numToAdd);
+        
+        position += numToAdd;
         
         if (inFifoMain.getFreeSpace() == 0)
         {
-            AudioBuffer<float> monoIn (1, blockSizeInternal);
-            
-            inFifoMain.readFromFifo (monoIn, blockSizeInternal);
+            inFifoMain.readFromFifo (blockInMain, blockSizeInternal);
             
             bool isReady = ! mSpatializer.isLoading.load()
                           && mCore.GetListener()->GetHRTF()->IsHRTFLoaded();
             
-            mSpatializer.processBlock (monoIn, scratchBufferMain);
-            outFifoMain.addToFifo (scratchBufferMain);
+            mSpatializer.processBlock (blockInMain, scratchBufferMain);
+            upsamplerMain.upsample (scratchBufferMain, blockSizeInternal, upsampledMain);
+            outFifoMain.addToFifo (upsampledMain);
 
             if (isReady)
             {
                 mEncoder.processBlock (mSpatializer.getSources(), scratchBufferBuss);
-                outFifoBuss.addToFifo (scratchBufferBuss);
+                upsamplerBuss.upsample (scratchBufferBuss, blockSizeInternal, upsampledBuss);
+                outFifoBuss.addToFifo (upsampledBuss);
             }
             else
             {
-                outFifoBuss.addSilenceToFifo (blockSizeInternal);
+                outFifoBuss.addSilenceToFifo (upsampledBuss.getNumSamples());
             }
         }
     }
@@ -295,6 +337,7 @@ void AnechoicPluginProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuff
     AudioSampleBuffer mainOutput = getBusBuffer (buffer, false, 0);
     
     outFifoMain.readFromFifo (mainOutput);
+    mOutputMeter.process (mainOutput, numSamples);
     
     if (sideChain.getNumChannels() >= outFifoBuss.getNumChannels())
         outFifoBuss.readFromFifo (sideChain);
@@ -316,109 +359,183 @@ AudioProcessorEditor* AnechoicPluginProcessor::createEditor()
 //==============================================================================
 void AnechoicPluginProcessor::getStateInformation (MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    auto state = treeState.copyState();
+    
+    auto position = getCore().getSourcePosition();
+    
+    auto source = state.getOrCreateChildWithName ("Source", nullptr);
+    source.setProperty ("X", position.x, nullptr);
+    source.setProperty ("Y", position.y, nullptr);
+    source.setProperty ("Z", position.z, nullptr);
+    
+    state.setProperty ("HRTFPath", getCore().getHrtfPath().getFullPathName(), nullptr);
+    state.setProperty ("SpatializationMode", getCore().spatializationMode.get(), nullptr);
+    
+    PluginState::write (state, destData);
 }
 
 void AnechoicPluginProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    auto state = PluginState::read (data, sizeInBytes);
+    
+    if (! state.hasType (treeState.state.getType()))
+        return;
+    
+    // Apply the whole state before the next block is processed
+    suspendProcessing (true);
+    
+    // The HRTF parameter would trigger a load of its own, so the
+    // selected file is restored explicitly and loaded only once
+    treeState.removeParameterListener ("HRTF", &mSpatializer);
+    treeState.replaceState (state);
+    treeState.addParameterListener ("HRTF", &mSpatializer);
+    
+    getCore().spatializationMode = (int)state.getProperty ("SpatializationMode", getCore().spatializationMode.get());
+    
+    auto source = state.getChildWithName ("Source");
+    
+    if (source.isValid() && ! getSources().empty())
+    {
+        Common::CVector3 position ((float)source["X"], (float)source["Y"], (float)source["Z"]);
+        getCore().setSourcePosition (position);
+    }
+    
+    getCore().restoreHRTF (File (state["HRTFPath"].toString()));
+    
+    // The restored file may differ from the saved one, e.g. if it was missing
+    if (getCore().getHrtfPath() != File())
+    {
+        auto* hrtf = treeState.getParameter ("HRTF");
+        
+        treeState.removeParameterListener ("HRTF", &mSpatializer);
+        hrtf->setValueNotifyingHost (hrtf->convertTo0to1 ((float)hrtfPathToBundledIndex (getCore().getHrtfPath())));
+        treeState.addParameterListener ("HRTF", &mSpatializer);
+    }
+    
+    suspendProcessing (false);
 }
 
-void AnechoicPluginProcessor::updateHostParameters()
+void AnechoicPluginProcessor::setUpHostSync()
 {
-  auto position = getCore().getSourcePosition (0);
+  auto& core = getCore();
   
-  auto sources = getCore().getSources();
-    
-  std::unordered_map<String, float> parameters = {
-    {"Azimuth", AzimuthMapper::fromToolkit (position.GetAzimuthDegrees())},
-    {"Distance", position.GetDistance()},
-    {"Elevation", mapElevationToSliderValue(position.GetElevationDegrees())},
-    {"X", position.x},
-    {"Y", position.y},
-    {"Z", position.z},
-    {"Source Attenuation", getCore().sourceDistanceAttenuation},
-    {"Enable Rev Dist Attenuation", getCore().enableReverbDistanceAttenuation},
-    {"Reverb Attenuation", getCore().reverbDistanceAttenuation},
-    {"Near Field", getCore().enableNearDistanceEffect},
-    {"Far Field", getCore().enableFarDistanceEffect},
-    {"Custom Head", getCore().enableCustomizedITD},
-    {"Head Circumference", getCore().headCircumference}
-  };
+  uint32 sourceFlags = 0;
+  sourceFlags |= hostSync.add ("Azimuth",   [&core] { return AzimuthMapper::fromToolkit (core.getSourcePosition().GetAzimuthDegrees()); });
+  sourceFlags |= hostSync.add ("Distance",  [&core] { return core.getSourcePosition().GetDistance(); });
+  sourceFlags |= hostSync.add ("Elevation", [&core] { return mapElevationToSliderValue (core.getSourcePosition().GetElevationDegrees()); });
+  sourceFlags |= hostSync.add ("X", [&core] { return core.getSourcePosition().x; });
+  sourceFlags |= hostSync.add ("Y", [&core] { return core.getSourcePosition().y; });
+  sourceFlags |= hostSync.add ("Z", [&core] { return core.getSourcePosition().z; });
+  
+  core.onSourceChanged = [this, sourceFlags] { hostSync.markDirty (sourceFlags); };
+  
+  hostSync.add ("Source Attenuation",          core.sourceDistanceAttenuation);
+  hostSync.add ("Enable Rev Dist Attenuation", core.enableReverbDistanceAttenuation);
+  hostSync.add ("Reverb Attenuation",          core.reverbDistanceAttenuation);
+  hostSync.add ("Near Field",                  core.enableNearDistanceEffect);
+  hostSync.add ("Far Field",                   core.enableFarDistanceEffect);
+  hostSync.add ("Custom Head",                 core.enableCustomizedITD);
+  hostSync.add ("Head Circumference",          core.headCircumference);
+  hostSync.add ("Head Yaw",                    core.listenerYaw);
+  hostSync.add ("Head Pitch",                  core.listenerPitch);
+  hostSync.add ("Head Roll",                   core.listenerRoll);
+  hostSync.add ("Head Tracking",               core.enableHeadTracking);
+  hostSync.add ("Stereo Spread",               core.stereoSpread);
+}
 
-  for (auto const & parameter : parameters)
-  {
-    if (AudioProcessorParameter* p = treeState.getParameter(parameter.first))
-    {
-      const float newValue = treeState.getParameterRange(parameter.first).convertTo0to1(parameter.second);
-      
-      if (fabs(p->getValue() - newValue) > std::numeric_limits<float>::epsilon())
-        p->setValueNotifyingHost(newValue);
-    }
-  }
+void AnechoicPluginProcessor::parameterValueChanged (int parameterIndex, float newValue)
+{
+  auto* parameter = static_cast<RangedAudioParameter*> (getParameters().getUnchecked (parameterIndex));
+  parameterChanged ((ParameterIndex)parameterIndex, parameter->convertFrom0to1 (newValue));
 }
 
-void AnechoicPluginProcessor::parameterChanged (const String& parameterID, float newValue)
+void AnechoicPluginProcessor::parameterChanged (ParameterIndex parameter, float newValue)
 {
-  auto sources = getCore().getSources();
+  auto const& sources = getCore().getSources();
+  
+  if (sources.empty())
+    return;
     
-  auto position = getCore().getSourcePosition(0);
+  auto position = getCore().getSourcePosition();
   
-  if ( parameterID == "Azimuth" )
+  switch (parameter)
   {
-    auto azimuth = AzimuthMapper::toToolkit (newValue);
-    position.SetFromAED (azimuth, position.GetElevationDegrees(), position.GetDistance());
-  } else if ( parameterID == "Distance" ) {
-    position.SetFromAED( position.GetAzimuthDegrees(), position.GetElevationDegrees(), newValue );
-  } else if ( parameterID == "Elevation" ) {
-    position.SetFromAED( position.GetAzimuthDegrees(), mapSliderValueToElevation(newValue), position.GetDistance() );
-  } else if ( parameterID == "X" ) {
-    position.x = newValue;
-  } else if ( parameterID == "Y" ) {
-    position.y = newValue;
-  } else if ( parameterID == "Z" ) {
-    position.z = newValue;
-  } else if ( parameterID == "Source Attenuation" ) {
-    getCore().sourceDistanceAttenuation = newValue;
-  } else if ( parameterID == "Enable Rev Dist Attenuation" ) {
-    getCore().enableReverbDistanceAttenuation = (bool)newValue;
-  } else if ( parameterID == "Reverb Attenuation" ) {
-    getCore().reverbDistanceAttenuation = newValue;
-  } else if ( parameterID == "Near Field" ) {
-    getCore().enableNearDistanceEffect = (int)(newValue + 0.49f);
-  } else if ( parameterID == "Far Field" ) {
-    getCore().enableFarDistanceEffect = (int)(newValue + 0.49f);
-  } else if ( parameterID == "Custom Head" ) {
-    getCore().enableCustomizedITD = (int)(newValue + 0.49f);
-  } else if ( parameterID == "Head Circumference" ) {
-    if ( getCore().enableCustomizedITD ){
-      getCore().headCircumference = newValue;
-    }
-  } else if ( parameterID == "Enable Anechoic" ) {
-    if ( auto source = getCore().getSources().front() ) {
-      bool enabled = (bool)newValue;
-      if ( enabled ) {
-        source->EnableAnechoicProcess();
+    case kAzimuth:
+      position.SetFromAED (AzimuthMapper::toToolkit (newValue), position.GetElevationDegrees(), position.GetDistance());
+      break;
+    case kDistance:
+      position.SetFromAED( position.GetAzimuthDegrees(), position.GetElevationDegrees(), newValue );
+      break;
+    case kElevation:
+      position.SetFromAED( position.GetAzimuthDegrees(), mapSliderValueToElevation(newValue), position.GetDistance() );
+      break;
+    case kX:
+      position.x = newValue;
+      break;
+    case kY:
+      position.y = newValue;
+      break;
+    case kZ:
+      position.z = newValue;
+      break;
+    case kSourceAttenuation:
+      getCore().sourceDistanceAttenuation = newValue;
+      return;
+    case kEnableRevDistAttenuation:
+      getCore().enableReverbDistanceAttenuation = (bool)newValue;
+      return;
+    case kReverbAttenuation:
+      getCore().reverbDistanceAttenuation = newValue;
+      return;
+    case kNearField:
+      getCore().enableNearDistanceEffect = (int)(newValue + 0.49f);
+      return;
+    case kFarField:
+      getCore().enableFarDistanceEffect = (int)(newValue + 0.49f);
+      return;
+    case kCustomHead:
+      getCore().enableCustomizedITD = (int)(newValue + 0.49f);
+      return;
+    case kHeadCircumference:
+      if ( getCore().enableCustomizedITD ){
+        getCore().headCircumference = newValue;
+      }
+      return;
+    case kHeadYaw:
+      getCore().listenerYaw = newValue;
+      return;
+    case kHeadPitch:
+      getCore().listenerPitch = newValue;
+      return;
+    case kHeadRoll:
+      getCore().listenerRoll = newValue;
+      return;
+    case kHeadTracking:
+      getCore().enableHeadTracking = newValue > 0.5f;
+      return;
+    case kStereoSpread:
+      getCore().stereoSpread = newValue;
+      return;
+    case kEnableAnechoic:
+      if ( (bool)newValue ) {
+        sources.front()->EnableAnechoicProcess();
       } else {
-        source->DisableAnechoicProcess();
+        sources.front()->DisableAnechoicProcess();
       }
-    }
-  } else if ( parameterID == "Enable Reverb" ) {
-    if ( auto source = getCore().getSources().front() ) {
-      bool enabled = (bool)newValue;
-      if ( enabled ) {
+      return;
+    case kEnableReverb:
+      if ( (bool)newValue ) {
         sources.front()->EnableReverbProcess();
       } else {
         sources.front()->DisableReverbProcess();
       }
-    }
+      return;
+    default:
+      // The HRTF is handled by the AnechoicProcessor
+      return;
   }
 
-  if (sources.size() > 0)
-      getCore().setSourcePosition (sources.front(), position);
+  getCore().setSourcePosition (position);
 }
 
 //==============================================================================
@@ -24,13 +24,15 @@
 #include <ff_buffers/ff_buffers_AudioBufferFIFO.h>
 #include "AnechoicProcessor.h"
 #include "AmbisonicEncoder.h"
+#include "IntegerResampler.h"
+#include "HostParameterSync.h"
 
 //==============================================================================
 /**
 */
 
 class AnechoicPluginProcessor  :  public  AudioProcessor
-                                , private AudioProcessorValueTreeState::Listener
+                                , private AudioProcessorParameter::Listener
 {
 public:
   //============================================================================
@@ -77,15 +79,52 @@ public:
   
   AnechoicProcessor& getCore()            { return mSpatializer; }
   
+  /** Measures the main output, at the host sample rate */
+  LevelMeter&        getOutputMeter()     { return mOutputMeter; }
+  
   AudioProcessorValueTreeState treeState;
   
 private:
   //============================================================================
-  void updateHostParameters();
+  /** Host parameters, in the order they are created */
+  enum ParameterIndex
+  {
+    kAzimuth,
+    kElevation,
+    kDistance,
+    kX,
+    kY,
+    kZ,
+    kSourceAttenuation,
+    kEnableRevDistAttenuation,
+    kReverbAttenuation,
+    kNearField,
+    kFarField,
+    kCustomHead,
+    kHeadCircumference,
+    kEnableAnechoic,
+    kEnableReverb,
+    kHRTF,
+    kHeadYaw,
+    kHeadPitch,
+    kHeadRoll,
+    kHeadTracking,
+    kStereoSpread,
+    kNumParameters
+  };
+  
+  void setUpHostSync();
+  
+  /** AudioProcessorParameter::Listener */
+  void parameterValueChanged (int parameterIndex, float newValue) override;
+  void parameterGestureChanged (int, bool) override {}
   
-  void parameterChanged(const String& parameterID, float newValue) override;
+  void parameterChanged (ParameterIndex parameter, float newValue);
     
   AudioBuffer<float>     scratchBufferMain, scratchBufferBuss;
+  AudioBuffer<float>     downsampledMain, blockInMain;
+  AudioBuffer<float>     upsampledMain, upsampledBuss;
+  IntegerResampler       downsamplerMain, upsamplerMain, upsamplerBuss;
   AudioBufferFIFO<float> inFifoMain  {2, 512},
                          outFifoMain {2, 512},
                          inFifoBuss  {2, 512},
@@ -96,6 +135,10 @@ private:
   AnechoicProcessor mSpatializer {mCore};
   AmbisonicEncoder  mEncoder {mCore};
   
+  HostParameterSync hostSync {treeState, *this};
+  
+  LevelMeter mOutputMeter;
+  
   //==============================================================================
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnechoicPluginProcessor)
 };
@@ -24,6 +24,37 @@
 #include "../Utils.h"
 #include "AnechoicProcessor.h"
 
+// Fraction of the remaining rotation applied per block, so that trackers
+// sending fewer updates than there are blocks don't make the scene jump
+static constexpr float kOrientationSmoothing = 0.5f;
+
+// Azimuth of a loudspeaker in the ITU-R BS.775 layouts, anticlockwise from
+// the front. Returns false for channel types with no place in those layouts.
+static bool getSpeakerAzimuth (AudioChannelSet::ChannelType type, float& azimuth)
+{
+    switch (type)
+    {
+        case AudioChannelSet::centre:            azimuth =  0.f;    return true;
+        case AudioChannelSet::left:              azimuth =  30.f;   return true;
+        case AudioChannelSet::right:             azimuth = -30.f;   return true;
+        case AudioChannelSet::leftSurround:      azimuth =  110.f;  return true;
+        case AudioChannelSet::rightSurround:     azimuth = -110.f;  return true;
+        case AudioChannelSet::leftSurroundSide:  azimuth =  90.f;   return true;
+        case AudioChannelSet::rightSurroundSide: azimuth = -90.f;   return true;
+        case AudioChannelSet::leftSurroundRear:  azimuth =  150.f;  return true;
+        case AudioChannelSet::rightSurroundRear: azimuth = -150.f;  return true;
+        case AudioChannelSet::centreSurround:    azimuth =  180.f;  return true;
+        default:                                                    return false;
+    }
+}
+
+// The LFE carries no direction. As in the BS.775 downmix to stereo,
+// it is left out of the binaural mix rather than given a position.
+static bool isLFE (AudioChannelSet::ChannelType type)
+{
+    return type == AudioChannelSet::LFE || type == AudioChannelSet::LFE2;
+}
+
 void initSource (CSingleSourceRef source, const Common::CVector3& position)
 {
     auto sourcePosition = Common::CTransform();
@@ -46,26 +77,57 @@ AnechoicProcessor::AnechoicProcessor (Binaural::CCore& core)
   ,  sourceDistanceAttenuation("5", "Source Distance Attenuation", NormalisableRange<float>(-6.f, 0.f, 0.1f), -6.f)
   ,  enableReverbDistanceAttenuation ("6", "Enable Rev Dist Attenuation", true)
   ,  reverbDistanceAttenuation("7", "Reverb Distance Attenuation", NormalisableRange<float>(-6.f, 0.f, 0.1f), -3.f)
+  ,  listenerYaw ("8", "Listener Yaw", NormalisableRange<float> (-180.f, 180.f), 0.f)
+  ,  listenerPitch ("9", "Listener Pitch", NormalisableRange<float> (-90.f, 90.f), 0.f)
+  ,  listenerRoll ("10", "Listener Roll", NormalisableRange<float> (-180.f, 180.f), 0.f)
+  ,  enableHeadTracking ("11", "Head Tracking", false)
+  ,  stereoSpread ("12", "Stereo Spread", NormalisableRange<float> (0.f, 180.f), 60.f)
   ,  mCore (core)
   ,  mListener (core.CreateListener())
 {
+    stereoSpread.addListener (this);
 }
 
 AnechoicProcessor::~AnechoicProcessor()
 {
+    stereoSpread.removeListener (this);
 }
 
 void AnechoicProcessor::setup (double sampleRate)
 {
-    auto position = getSourcePosition();
+    // Processing switches made before setup, e.g. when restoring the
+    // plugin state, carry over to the new sources
+    auto previous = mSources.empty() ? nullptr : mSources.front();
     
-    if (! mSources.empty())
+    mSources.clear();
+    mAzimuthOffsets.clear();
+    mInputBuffers.clear();
+    mSourceChannels.clear();
+    
+    // One virtual source per input channel, sharing the listener and its HRTF
+    for (int channel = 0; channel < mInputLayout.size(); ++channel)
+    {
+        if (! isLFE (mInputLayout.getTypeOfChannel (channel)))
+            mSourceChannels.push_back (channel);
+    }
+    
+    if (mSourceChannels.empty())
+        mSourceChannels.push_back (0);
+    
+    // Positions are published in fixed-size snapshots
+    jassert ((int)mSourceChannels.size() <= kMaxSources);
+    mSourceChannels.resize (jmin ((int)mSourceChannels.size(), kMaxSources));
+    
+    for (size_t i = 0; i < mSourceChannels.size(); ++i)
     {
-        mSources.clear();
-        mTransforms.clear();
+        addSoundSource (mInputPosition);
+        
+        if (previous != nullptr)
+            copySourceSettings (previous, mSources.back());
     }
     
-    addSoundSource (position);
+    mRenderedPositions = {};
+    layoutSources();
     
     auto blockSize = mCore.GetAudioState().bufferSize;
     
@@ -73,16 +135,28 @@ void AnechoicProcessor::setup (double sampleRate)
     mOutputBuffer.left .resize (blockSize);
     mOutputBuffer.right.resize (blockSize);
     
+    // Buffers are reused for every block, so none is allocated while processing
+    mInputBuffers.assign (mSources.size(), CMonoBuffer<float> (blockSize));
+    mAnechoicBuffer.left .resize (blockSize);
+    mAnechoicBuffer.right.resize (blockSize);
+    
+    mMeter.prepare (sampleRate, 2);
+    
     auto loadedHrtf = getHrtfPath();
     
-    if (loadedHrtf.exists())
+    // A restored bundled HRTF is only known by name until now
+    if (loadedHrtf != File())
     {
         if (sampleRate != mSampleRate)
         {
             int index = hrtfPathToBundledIndex (loadedHrtf);
             
-            if (index >= 0)
+            // Bundled HRTFs are swapped for the version matching the
+            // new sample rate, custom files are reloaded as they are
+            if (index < BundledHRTFs.size() - 2)
                 loadHRTF (getBundledHRTF (index, sampleRate));
+            else if (! loadHRTF (loadedHrtf))
+                loadHRTF (getBundledHRTF (0, sampleRate));
         }
         
         mSampleRate = sampleRate;
@@ -106,34 +180,56 @@ bool AnechoicProcessor::loadHRTF (const File& hrtf)
         return false;
     }
     
-    __loadHRTF(hrtf);
-
     auto sampleRate = mCore.GetAudioState().sampleRate;
-
-    // Load HRTF ILD
-    File hrtfILD = ILDDirectory().getChildFile(SampleRateToDefaultHRTF_ILD.at((int)sampleRate));
-    if (! hrtfILD.existsAsFile())
+    
+    if (SampleRateToDefaultHRTF_ILD.count (sampleRate) == 0)
     {
-        DBG ("HRTF ILD file doesn't exist");
+        DBG ("No ILD resources for a sample rate of " << sampleRate);
         isLoading.store (false);
         return false;
     }
     
-    __loadHRTF_ILD (hrtfILD);
-
-    // Load near field ILD
-    File nearFieldConf = ILDDirectory().getChildFile (SampleRateToNearFieldILD.at((int)sampleRate));
-    if (! nearFieldConf.existsAsFile() ) {
-        DBG ("Near field ILD file doesn't exist");
+    if (! __loadHRTF (hrtf))
+    {
         isLoading.store (false);
         return false;
     }
-
-
-    DBG("Loading ILD (near field): " + nearFieldConf.getFullPathName());
-    if ( !ILD::CreateFrom3dti_ILDNearFieldEffectTable( nearFieldConf.getFullPathName().toStdString(), mListener )) {
-        DBG ("Unable to load ILD Near Field Effect simulation file. Near (ILD) will not work");
-        return false;
+    
+    // The ILD tables only depend on the sample rate, so they are
+    // kept when switching between HRTFs at the same rate
+    if (sampleRate != mILDSampleRate)
+    {
+        // Load HRTF ILD
+        File hrtfILD = ILDDirectory().getChildFile(SampleRateToDefaultHRTF_ILD.at((int)sampleRate));
+        if (! hrtfILD.existsAsFile())
+        {
+            DBG ("HRTF ILD file doesn't exist");
+            isLoading.store (false);
+            return false;
+        }
+        
+        if (! __loadHRTF_ILD (hrtfILD))
+        {
+            isLoading.store (false);
+            return false;
+        }
+        
+        // Load near field ILD
+        File nearFieldConf = ILDDirectory().getChildFile (SampleRateToNearFieldILD.at((int)sampleRate));
+        if (! nearFieldConf.existsAsFile() ) {
+            DBG ("Near field ILD file doesn't exist");
+            isLoading.store (false);
+            return false;
+        }
+        
+        DBG("Loading ILD (near field): " + nearFieldConf.getFullPathName());
+        if ( !ILD::CreateFrom3dti_ILDNearFieldEffectTable( nearFieldConf.getFullPathName().toStdString(), mListener )) {
+            DBG ("Unable to load ILD Near Field Effect simulation file. Near (ILD) will not work");
+            isLoading.store (false);
+            return false;
+        }
+        
+        mILDSampleRate = sampleRate;
     }
     
     // Re-enable processing
@@ -144,7 +240,37 @@ bool AnechoicProcessor::loadHRTF (const File& hrtf)
     return true;
 }
 
-void AnechoicProcessor::processBlock (AudioBuffer<float>& monoIn, AudioBuffer<float>& stereoOut)
+void AnechoicProcessor::restoreHRTF (const File& file)
+{
+    if (file == File() || file == hrtfPath)
+        return;
+    
+    auto hrtf  = file;
+    int  index = hrtfPathToBundledIndex (hrtf);
+    
+    // Bundled HRTFs are matched by name, as they may be installed somewhere
+    // else on this machine or saved at another sample rate. A missing custom
+    // file falls back to the default.
+    if (index < BundledHRTFs.size() - 2)
+    {
+        hrtf = getBundledHRTF (index, mSampleRate);
+    }
+    else if (! hrtf.existsAsFile())
+    {
+        showMissingResourceAlert ("HRTF", hrtf);
+        hrtf = getBundledHRTF (0, mSampleRate);
+    }
+    
+    if (hrtf == hrtfPath)
+        return;
+    
+    if (mSampleRate > 0.0)
+        loadHRTF (hrtf);
+    else
+        hrtfPath = hrtf;
+}
+
+void AnechoicProcessor::processBlock (AudioBuffer<float>& input, AudioBuffer<float>& stereoOut)
 {
     if (isLoading.load())
     {
@@ -157,22 +283,26 @@ void AnechoicProcessor::processBlock (AudioBuffer<float>& monoIn, AudioBuffer<fl
     // Initializes buffer with zeros
     _3dti_clear (mOutputBuffer);
     
-    // Getting the processed audio
-    // Declaration, initialization and filling mono buffers
-    CMonoBuffer<float> input = juceTo3dti (monoIn);
-    
     // Spatialize
     if (mListener->GetHRTF()->IsHRTFLoaded())
     {
-        for ( auto const& source : getSources() )
+        for (size_t i = 0; i < mSources.size(); ++i)
         {
-            CMonoBufferPair anechoicBuffer;
+            auto const& source = mSources[i];
+            
+            // Each virtual source renders its own channel of the input
+            auto& channel = mInputBuffers[i];
+            jassert ((int)channel.size() == input.getNumSamples());
+            
+            FloatVectorOperations::copy (channel.data(),
+                                         input.getReadPointer (jmin (mSourceChannels[i], input.getNumChannels() - 1)),
+                                         (int)channel.size());
             
-            source->SetBuffer(input);
-            source->ProcessAnechoic(anechoicBuffer.left, anechoicBuffer.right);
+            source->SetBuffer (channel);
+            source->ProcessAnechoic(mAnechoicBuffer.left, mAnechoicBuffer.right);
             
-            mOutputBuffer.left  += anechoicBuffer.left;
-            mOutputBuffer.right += anechoicBuffer.right;
+            mOutputBuffer.left  += mAnechoicBuffer.left;
+            mOutputBuffer.right += mAnechoicBuffer.right;
         }
     }
     
@@ -190,8 +320,29 @@ void AnechoicProcessor::processBlock (AudioBuffer<float>& monoIn, AudioBuffer<fl
                 stereoOut.getWritePointer(0)[i] = mOutputBuffer.left[i];
         }
     }
+    
+    mMeter.process (stereoOut, stereoOut.getNumSamples());
+}
+
+//==============================================================================
+void AnechoicProcessor::handleAsyncUpdate()
+{
+    if (mInputLayout == AudioChannelSet::stereo())
+        layoutSources();
 }
 
+void AnechoicProcessor::parameterValueChanged (int parameterIndex, float newValue)
+{
+    // The spread may be automated from the audio thread, so the sources
+    // are laid out again on the message thread, where they are moved
+    triggerAsyncUpdate();
+}
+
+void AnechoicProcessor::parameterGestureChanged (int parameterIndex, bool gestureIsStarting)
+{
+}
+
+//==============================================================================
 void AnechoicProcessor::parameterChanged (const String& parameterID, float newValue)
 {
     int index = std::floor (newValue);
@@ -222,11 +373,35 @@ void AnechoicProcessor::updateParameters()
     auto headradius_cm = headCircumference / (2.0 * M_PI * 10.0);
     mListener->SetHeadRadius(headradius_cm / 100.0);
     
+    updateListenerOrientation();
+    
+    // Take up the latest layout. If it was published again while being
+    // copied, the sources keep their positions until the next block.
+    SourcePositions latest;
+    uint32 version;
+    
+    if (readSourcePositions (latest, version))
+        mRenderedPositions = latest;
+    
     const auto numSources = mSources.size();
     for ( auto i = 0; i < numSources; i++ )
     {
         auto const& source = mSources[i];
         
+        // Virtual sources follow the processing switches of the first one
+        if (i > 0)
+        {
+            if (mSources.front()->IsAnechoicProcessEnabled())
+                source->EnableAnechoicProcess();
+            else
+                source->DisableAnechoicProcess();
+            
+            if (mSources.front()->IsReverbProcessEnabled())
+                source->EnableReverbProcess();
+            else
+                source->DisableReverbProcess();
+        }
+        
         source->SetSpatializationMode ((Binaural::TSpatializationMode)spatializationMode.get());
         
         if ( enableNearDistanceEffect ) {
@@ -246,7 +421,12 @@ void AnechoicProcessor::updateParameters()
         else
             source->DisableDistanceAttenuationReverb();
         
-        source->SetSourceTransform( mTransforms[i] );
+        if (i < mRenderedPositions.numSources)
+        {
+            Common::CTransform transform;
+            transform.SetPosition (mRenderedPositions.positions[i]);
+            source->SetSourceTransform (transform);
+        }
     }
     
     auto magnitudes = mCore.GetMagnitudes();
@@ -255,6 +435,122 @@ void AnechoicProcessor::updateParameters()
     mCore.SetMagnitudes(magnitudes);
 }
 
+void AnechoicProcessor::updateAzimuthOffsets()
+{
+    const float spread = stereoSpread.get();
+    const bool isStereo = mInputLayout == AudioChannelSet::stereo();
+    
+    for (size_t i = 0; i < mAzimuthOffsets.size() && i < mSourceChannels.size(); ++i)
+    {
+        auto type = mInputLayout.getTypeOfChannel (mSourceChannels[i]);
+        
+        if (isStereo)
+            mAzimuthOffsets[i] = (type == AudioChannelSet::left ? 0.5f : -0.5f) * spread;
+        else if (! getSpeakerAzimuth (type, mAzimuthOffsets[i]))
+            mAzimuthOffsets[i] = 0.f;
+    }
+}
+
+bool AnechoicProcessor::isInputLayoutSupported (const AudioChannelSet& layout)
+{
+    bool hasDirectionalChannel = false;
+    
+    for (auto type : layout.getChannelTypes())
+    {
+        float azimuth;
+        
+        if (getSpeakerAzimuth (type, azimuth))
+            hasDirectionalChannel = true;
+        else if (! isLFE (type))
+            return false;
+    }
+    
+    return hasDirectionalChannel;
+}
+
+void AnechoicProcessor::layoutSources()
+{
+    {
+        const SpinLock::ScopedLockType lock (mLayoutLock);
+        
+        updateAzimuthOffsets();
+        
+        // Fill the slot that isn't published. The fence keeps these writes
+        // from overtaking the previous publish, which readers of this slot
+        // check for.
+        auto version = mPositionsVersion.load (std::memory_order_relaxed) + 1;
+        auto& layout = mPublishedPositions[version & 1];
+        
+        std::atomic_thread_fence (std::memory_order_release);
+        
+        auto const& centre = mInputPosition;
+        layout.numSources = jmin ((int)mAzimuthOffsets.size(), kMaxSources);
+        
+        for (int i = 0; i < layout.numSources; ++i)
+        {
+            auto position = centre;
+            
+            if (mAzimuthOffsets[i] != 0.f)
+                position.SetFromAED (centre.GetAzimuthDegrees() + mAzimuthOffsets[i], centre.GetElevationDegrees(), centre.GetDistance());
+            
+            layout.positions[i] = position;
+        }
+        
+        mPositionsVersion.store (version, std::memory_order_release);
+    }
+    
+    sourceChanged();
+}
+
+bool AnechoicProcessor::readSourcePositions (SourcePositions& copy, uint32& version) const
+{
+    version = mPositionsVersion.load (std::memory_order_acquire);
+    copy = mPublishedPositions[version & 1];
+    
+    // The slot is only refilled after another publish, which would show here
+    std::atomic_thread_fence (std::memory_order_acquire);
+    return mPositionsVersion.load (std::memory_order_relaxed) == version;
+}
+
+void AnechoicProcessor::updateListenerOrientation()
+{
+    bool changed = false;
+    
+    auto approach = [&changed] (float& current, float target)
+    {
+        float delta = target - current;
+        delta -= 360.f * std::round (delta / 360.f); // The short way round
+        
+        if (delta == 0.f)
+            return;
+        
+        current = std::abs (delta) < 0.01f ? target : current + kOrientationSmoothing * delta;
+        changed = true;
+    };
+    
+    // The tracker turns the head away from the orientation set by the
+    // parameters, which stay under the user's and the host's control
+    HeadTrackingReceiver::Orientation tracked;
+    
+    if (! mHeadTracker.getOrientation (tracked))
+        tracked = {};
+    
+    approach (mYaw,   listenerYaw.get() + tracked.yaw);
+    approach (mPitch, jlimit (-90.f, 90.f, listenerPitch.get() + tracked.pitch));
+    approach (mRoll,  listenerRoll.get() + tracked.roll);
+    
+    // Sources are positioned relative to the listener by the toolkit, so
+    // turning the head is one transform however many sources there are
+    if (changed)
+    {
+        auto transform = mListener->GetListenerTransform();
+        transform.SetOrientation (Common::CQuaternion::FromYawPitchRoll (degreesToRadians (mYaw),
+                                                                         degreesToRadians (mPitch),
+                                                                         degreesToRadians (mRoll)));
+        mListener->SetListenerTransform (transform);
+    }
+}
+
 bool AnechoicProcessor::__loadHRTF (const File& file)
 {
     DBG("Loading HRTF: " << file.getFullPathName());
@@ -292,9 +588,7 @@ bool AnechoicProcessor::loadResourceFile(const File& file)
     // TODO: Throw exception / return error and trigger warning from editor
     if (fileSampleRate != sampleRate)
     {
-        AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Wrong sample rate",
-                                         "Please select a file that matches the project sample rate",
-                                         "OK");
+        showWrongSampleRateAlert (fileSampleRate, sampleRate);
         return false;
     }
     
@@ -311,8 +605,36 @@ void AnechoicProcessor::addSoundSource (const Common::CVector3& position) {
     initSource (source, position);
     
     mSources.push_back (source);
-    mTransforms.push_back (Common::CTransform());
-    mTransforms.back().SetPosition (Common::CVector3 (1,0,0));
+    mAzimuthOffsets.push_back (0.f);
+    mInputBuffers.push_back (CMonoBuffer<float> (mOutputBuffer.left.size()));
+    layoutSources();
+}
+
+uint32 AnechoicProcessor::getSourcePositions (Array<Common::CVector3>& positions) const
+{
+    SourcePositions snapshot;
+    uint32 version;
+    
+    // Only fails if the layout was published again during the copy
+    while (! readSourcePositions (snapshot, version)) {}
+    
+    positions.clearQuick();
+    positions.addArray (snapshot.positions.data(), snapshot.numSources);
+    
+    return version;
+}
+
+Common::CVector3 AnechoicProcessor::getSourcePosition (int index) const
+{
+    SourcePositions snapshot;
+    uint32 version;
+    
+    while (! readSourcePositions (snapshot, version)) {}
+    
+    if (index < 0 || index >= snapshot.numSources)
+        return Common::CVector3 (0, 1, 0);
+    
+    return snapshot.positions[index];
 }
 
 void AnechoicProcessor::loadCustomHRTF (String fileTypes, std::function<void(File)> callback)
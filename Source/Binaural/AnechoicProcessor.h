@@ -22,6 +22,8 @@
 
 #include <BinauralSpatializer/3DTI_BinauralSpatializer.h>
 #include <JuceHeader.h>
+#include "Common/LevelMeter.h"
+#include "HeadTrackingReceiver.h"
 
 using CSingleSourceRef = shared_ptr<Binaural::CSingleSourceDSP>;
 using CMonoBufferPair  = Common::CEarPair<CMonoBuffer<float>>;
@@ -30,7 +32,9 @@ using CMonoBufferPair  = Common::CEarPair<CMonoBuffer<float>>;
 void copySourceSettings(CSingleSourceRef oldSource, CSingleSourceRef newSource);
 
 class AnechoicProcessor   : public  ChangeBroadcaster,
-                            public  AudioProcessorValueTreeState::Listener
+                            public  AudioProcessorValueTreeState::Listener,
+                            private AsyncUpdater,
+                            private AudioProcessorParameter::Listener
 {
 public:
     //============================================================================
@@ -41,9 +45,21 @@ public:
     //============================================================================
     void setup (double sampleRate/*, int frameSize TODO: Currently fixed*/);
     
-    void processBlock (AudioBuffer<float>& monoIn, AudioBuffer<float>& stereoOut);
+    /** Renders each channel of input through its own virtual source */
+    void processBlock (AudioBuffer<float>& input, AudioBuffer<float>& stereoOut);
     
     //============================================================================
+    /** Sets the channels rendered by processBlock(). Each becomes a virtual
+        source placed around the input position, at the speaker angle of its
+        channel type or, for stereo, at stereoSpread. Takes effect on setup().
+     */
+    void setInputLayout (const AudioChannelSet& layout) { mInputLayout = layout; }
+    
+    /** @returns true if every channel of the layout has a speaker angle or is
+        an LFE, which is left out of the mix, and at least one is not an LFE
+     */
+    static bool isInputLayoutSupported (const AudioChannelSet& layout);
+    
     void addSoundSource(const Common::CVector3& position);
     
     const std::vector<CSingleSourceRef>& getSources() { return mSources; }
@@ -51,15 +67,27 @@ public:
     //==========================================================================
     bool loadHRTF (const File& file);
     
+    /** Restores a previously selected HRTF. Before setup() has been called the
+        file is only remembered, so that setup() loads it exactly once.
+        
+        If the file is missing, the bundled HRTF of the same name is used, or
+        the default one after telling the user. Check getHrtfPath() afterwards.
+     */
+    void restoreHRTF (const File& file);
+    
     File getHrtfPath() const { return hrtfPath; }
     
+    /** Measures the anechoic output */
+    LevelMeter& getLevelMeter() { return mMeter; }
+    
     //==========================================================================
     inline float getHeadRadius() const {
         return (headCircumference / (2.f * M_PI)) * 0.001f;
     }
     
     // TODO: Source Position as AudioParameterValueTree?
-    inline void setSourcePosition(const CSingleSourceRef source, Common::CVector3 pos)
+    /** Moves the input, i.e. every virtual source along with it */
+    inline void setSourcePosition (Common::CVector3 pos)
     {
         auto headRadius = getHeadRadius();
         auto distance = pos.GetDistance();
@@ -68,29 +96,64 @@ public:
             pos.SetFromAED(pos.GetAzimuthDegrees(), pos.GetElevationDegrees(), newDistance);
         }
         
+        mInputPosition = pos;
+        layoutSources();
+    }
+    
+    /** Moves the input so that one of its virtual sources ends up at pos */
+    inline void setSourcePosition(const CSingleSourceRef source, Common::CVector3 pos)
+    {
         auto it = std::find (mSources.begin(), mSources.end(), source);
         if ( it != mSources.end() )
         {
-            auto idx = std::distance (mSources.begin(), it);
-            mTransforms[idx].SetPosition (pos);
+            float offset;
+            
+            {
+                const SpinLock::ScopedLockType lock (mLayoutLock);
+                offset = mAzimuthOffsets[std::distance (mSources.begin(), it)];
+            }
+            
+            if (offset != 0.f)
+                pos.SetFromAED (pos.GetAzimuthDegrees() - offset, pos.GetElevationDegrees(), pos.GetDistance());
+            
+            setSourcePosition (pos);
         }
         else DBG ("Source not found");
     }
     
-    inline Common::CVector3 getSourcePosition (int index = 0)
+    /** Called after a source has been moved or had its processing switched,
+        on the thread that made the change
+     */
+    std::function<void()> onSourceChanged;
+    
+    void sourceChanged()
     {
-        if (index > (int)mSources.size() - 1)
-            return Common::CVector3 (0, 1, 0);
-        
-        return mTransforms[index].GetPosition();
+        if (onSourceChanged != nullptr)
+            onSourceChanged();
     }
     
+    /** @returns the position of the input */
+    inline Common::CVector3 getSourcePosition() const { return mInputPosition; }
+    
+    /** @returns the position of one virtual source */
+    Common::CVector3 getSourcePosition (int index) const;
+    
+    /** Copies the position of every source, in the order of getSources(),
+        from the last layout published. Safe to call from any thread.
+        
+        @returns the positions version the copy corresponds to
+     */
+    uint32 getSourcePositions (Array<Common::CVector3>& positions) const;
+    
+    /** Changes whenever a source is added or moved, so that views can skip
+        frames where nothing moved without copying any positions
+     */
+    uint32 getSourcePositionsVersion() const { return mPositionsVersion.load(); }
+    
     inline Common::CVector3 getSourcePosition (CSingleSourceRef source)
     {
-        if (mSources.empty())
-            return Common::CVector3 (0, 1, 0);
-        
-        return getSourcePosition (0);
+        auto it = std::find (mSources.begin(), mSources.end(), source);
+        return getSourcePosition ((int)std::distance (mSources.begin(), it));
     }
     
     //==========================================================================
@@ -104,25 +167,84 @@ public:
     AudioParameterBool  enableReverbDistanceAttenuation;
     AudioParameterFloat reverbDistanceAttenuation;
     
+    /** Listener orientation in degrees, applied once per block. While head
+        tracking is on, the tracked orientation is added to it.
+     */
+    AudioParameterFloat listenerYaw;
+    AudioParameterFloat listenerPitch;
+    AudioParameterFloat listenerRoll;
+    
+    /** Lets a head tracker on this machine turn the listener */
+    AudioParameterBool  enableHeadTracking;
+    
+    /** Angle between the virtual sources of a stereo input, in degrees */
+    AudioParameterFloat stereoSpread;
+    
     std::atomic<bool> isLoading {false};
     
     void parameterChanged (const String& parameterID, float newValue) override;
     
 private:
+    //============================================================================
+    /** AsyncUpdater */
+    void handleAsyncUpdate() override;
+    
+    /** AudioProcessorParameter::Listener */
+    void parameterValueChanged (int parameterIndex, float newValue) override;
+    void parameterGestureChanged (int parameterIndex, bool gestureIsStarting) override;
+    
     //============================================================================
     void updateParameters();
+    void updateListenerOrientation();
+    
+    /** Places every virtual source around the input position and publishes
+        the positions. Callers on different threads are serialised.
+     */
+    void layoutSources();
+    void updateAzimuthOffsets();
     bool __loadHRTF (const File& file);
     bool __loadHRTF_ILD (const File& file);
     bool loadResourceFile (const File& file);
     void loadCustomHRTF (String fileTypes, std::function<void(File)> chosen);
     
     //============================================================================
-    double mSampleRate;
+    double mSampleRate = 0.0;
+    double mILDSampleRate = 0.0;
     Binaural::CCore& mCore;
     std::shared_ptr<Binaural::CListener>    mListener;
     CMonoBufferPair                         mOutputBuffer;
+    std::vector<CMonoBuffer<float>>         mInputBuffers;   // One per source
+    CMonoBufferPair                         mAnechoicBuffer;
     std::vector<CSingleSourceRef>           mSources;
-    std::vector<Common::CTransform>         mTransforms;
+    
+    // The positions of the sources are double-buffered. The published slot
+    // is mPositionsVersion & 1, and a reader that sees the version change
+    // while copying drops its copy instead of waiting for the writer.
+    static constexpr int kMaxSources = 8;
+    
+    struct SourcePositions
+    {
+        std::array<Common::CVector3, kMaxSources> positions;
+        int numSources = 0;
+    };
+    
+    bool readSourcePositions (SourcePositions& copy, uint32& version) const;
+    
+    SourcePositions                         mPublishedPositions[2];
+    std::atomic<uint32>                     mPositionsVersion {0};
+    SourcePositions                         mRenderedPositions;   // Audio thread only
+    SpinLock                                mLayoutLock;
+    
+    AudioChannelSet    mInputLayout = AudioChannelSet::mono();
+    Common::CVector3   mInputPosition {1, 0, 0};
+    std::vector<float> mAzimuthOffsets;   // One per source, in degrees
+    std::vector<int>   mSourceChannels;   // Input channel rendered by each source
+    LevelMeter                              mMeter;
+    
+    // Orientation currently applied to the listener, in degrees
+    float mYaw = 0.f, mPitch = 0.f, mRoll = 0.f;
+    
+    HeadTrackingReceiver mHeadTracker {enableHeadTracking};
     
     File hrtfPath;
     std::unique_ptr<FileChooser> fc;
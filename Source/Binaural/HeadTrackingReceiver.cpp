@@ -0,0 +1,281 @@
+/**
+ * \class HeadTrackingReceiver
+ *
+ * \brief Implementation of HeadTrackingReceiver interface.
+ * \date  October 2026
+ *
+ * \authors Reactify Music LLP: R. Hrafnkelsson ||
+ * Coordinated by , A. Reyes-Lecuona (University of Malaga) and L.Picinali (Imperial College London) ||
+ * \b Contact: areyes@uma.es and l.picinali@imperial.ac.uk
+ *
+ * \b Project: 3DTI (3D-games for TUNing and lEarnINg about hearing aids) ||
+ * \b Website: http://3d-tune-in.eu/
+ *
+ * \b Copyright: University of Malaga and Imperial College London - 2026
+ *
+ * \b Licence: This copy of the 3D Tune-In Toolkit Plugin is licensed to you under the terms described in the LICENSE.md file included in this distribution.
+ *
+ * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
+ */
+
+#include <BinauralSpatializer/3DTI_BinauralSpatializer.h>
+#include "HeadTrackingReceiver.h"
+
+static const char* const kYawPitchRollAddress = "/3dti/head/ypr";
+static const char* const kQuaternionAddress   = "/3dti/head/quaternion";
+
+// Large enough for either message
+static constexpr int kMaxMessageSize = 128;
+
+// How often the enable parameter is checked
+static constexpr int kPollIntervalMs = 250;
+
+//==============================================================================
+// OSC strings are null terminated and padded to a multiple of four bytes
+static bool readString (const char* data, int size, int& position, String& result)
+{
+    int length = 0;
+
+    while (position + length < size && data[position + length] != 0)
+        ++length;
+
+    if (position + length >= size)
+        return false;
+
+    result = String (data + position, (size_t)length);
+    position += (length / 4 + 1) * 4;
+
+    return position <= size;
+}
+
+static void writeString (MemoryOutputStream& stream, const char* text)
+{
+    auto length = (int)std::strlen (text);
+    stream.write (text, (size_t)length);
+
+    for (int i = length; i < (length / 4 + 1) * 4; ++i)
+        stream.writeByte (0);
+}
+
+static void showPortInUseAlert (int port)
+{
+    String message;
+    message << "Head tracking needs UDP port " << port << ", which is used by another application "
+            << "or by this plugin running in another process.\n\n"
+            << "Free the port, then switch head tracking off and on again.";
+
+    AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon, "Head tracking unavailable", message, "OK");
+}
+
+//==============================================================================
+HeadTrackingReceiver::HeadTrackingReceiver (AudioParameterBool& enabled)
+  : mEnabled (enabled)
+{
+    startTimer (kPollIntervalMs);
+}
+
+HeadTrackingReceiver::~HeadTrackingReceiver()
+{
+    stopTimer();
+
+    if (mListening)
+        mShared->removeUser();
+}
+
+//==============================================================================
+bool HeadTrackingReceiver::handleMessage (const void* data, int size)
+{
+    Orientation orientation;
+
+    if (! parseMessage (data, size, orientation))
+        return false;
+
+    mShared->setOrientation (orientation);
+    return true;
+}
+
+bool HeadTrackingReceiver::getOrientation (Orientation& orientation) const
+{
+    return mEnabled.get() && mShared->getOrientation (orientation);
+}
+
+bool HeadTrackingReceiver::parseMessage (const void* data, int size, Orientation& orientation)
+{
+    auto* bytes = static_cast<const char*> (data);
+    int position = 0;
+
+    String address, typeTags;
+
+    if (! readString (bytes, size, position, address) || ! readString (bytes, size, position, typeTags))
+        return false;
+
+    const int numArguments = typeTags.length() - 1;
+
+    if (! typeTags.startsWithChar (',') || typeTags.substring (1) != String::repeatedString ("f", numArguments))
+        return false;
+
+    if (position + numArguments * 4 > size)
+        return false;
+
+    float arguments[4];
+
+    for (int i = 0; i < numArguments && i < 4; ++i)
+    {
+        auto bits = ByteOrder::bigEndianInt (bytes + position + i * 4);
+        std::memcpy (&arguments[i], &bits, sizeof (float));
+    }
+
+    if (address == kYawPitchRollAddress && numArguments == 3)
+    {
+        orientation = {arguments[0], arguments[1], arguments[2]};
+        return true;
+    }
+
+    if (address == kQuaternionAddress && numArguments == 4)
+    {
+        Common::CQuaternion quaternion (arguments[0], arguments[1], arguments[2], arguments[3]);
+
+        float yaw, pitch, roll;
+        quaternion.ToYawPitchRoll (yaw, pitch, roll);
+
+        orientation = {radiansToDegrees (yaw), radiansToDegrees (pitch), radiansToDegrees (roll)};
+        return true;
+    }
+
+    return false;
+}
+
+MemoryBlock HeadTrackingReceiver::createMessage (const Orientation& orientation)
+{
+    MemoryBlock message;
+    MemoryOutputStream stream (message, false);
+
+    writeString (stream, kYawPitchRollAddress);
+    writeString (stream, ",fff");
+
+    for (auto value : {orientation.yaw, orientation.pitch, orientation.roll})
+        stream.writeFloatBigEndian (value);
+
+    stream.flush();
+
+    return message;
+}
+
+//==============================================================================
+void HeadTrackingReceiver::timerCallback()
+{
+    const bool shouldListen = mEnabled.get();
+
+    // Switching tracking off is the user's way of asking for another try
+    if (! shouldListen)
+        mPortInUse = false;
+
+    if (shouldListen == mListening || mPortInUse)
+        return;
+
+    if (shouldListen)
+    {
+        if (! mShared->addUser())
+        {
+            mPortInUse = true;
+            showPortInUseAlert (kDefaultPort);
+            return;
+        }
+
+        mListening = true;
+    }
+    else
+    {
+        mShared->removeUser();
+        mListening = false;
+    }
+}
+
+//==============================================================================
+HeadTrackingReceiver::SharedSocket::SharedSocket()
+  : Thread ("Head Tracking")
+{
+}
+
+HeadTrackingReceiver::SharedSocket::~SharedSocket()
+{
+    if (mSocket != nullptr)
+        close();
+}
+
+bool HeadTrackingReceiver::SharedSocket::addUser()
+{
+    if (mNumUsers == 0)
+    {
+        mSocket = std::make_unique<DatagramSocket> (false);
+
+        // Only trackers on this machine can move the listener
+        if (! mSocket->bindToPort (kDefaultPort, "127.0.0.1"))
+        {
+            DBG ("Head tracking: port " + String (kDefaultPort) + " is in use");
+            mSocket.reset();
+            return false;
+        }
+
+        startThread();
+    }
+
+    ++mNumUsers;
+    return true;
+}
+
+void HeadTrackingReceiver::SharedSocket::removeUser()
+{
+    jassert (mNumUsers > 0);
+
+    if (--mNumUsers == 0)
+        close();
+}
+
+void HeadTrackingReceiver::SharedSocket::close()
+{
+    signalThreadShouldExit();
+    mSocket->shutdown();
+    stopThread (1000);
+    mSocket.reset();
+
+    // Start from the listener parameters alone next time
+    mHasOrientation = false;
+}
+
+void HeadTrackingReceiver::SharedSocket::setOrientation (const Orientation& orientation)
+{
+    // A reader may see a mix of two consecutive messages, which is
+    // harmless at tracker rates given the smoothing on the audio thread
+    mYaw   = orientation.yaw;
+    mPitch = jlimit (-90.f, 90.f, orientation.pitch);
+    mRoll  = orientation.roll;
+    mHasOrientation = true;
+}
+
+bool HeadTrackingReceiver::SharedSocket::getOrientation (Orientation& orientation) const
+{
+    if (! mHasOrientation.load())
+        return false;
+
+    orientation = {mYaw.load(), mPitch.load(), mRoll.load()};
+    return true;
+}
+
+void HeadTrackingReceiver::SharedSocket::run()
+{
+    char buffer[kMaxMessageSize];
+
+    while (! threadShouldExit())
+    {
+        if (mSocket->waitUntilReady (true, 100) != 1)
+            continue;
+
+        auto numBytes = mSocket->read (buffer, kMaxMessageSize, false);
+
+        Orientation orientation;
+
+        if (numBytes > 0 && parseMessage (buffer, numBytes, orientation))
+            setOrientation (orientation);
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * \class HeadTrackingReceiver
+ *
+ * \brief Declaration of HeadTrackingReceiver interface.
+ * \date  October 2026
+ *
+ * \authors Reactify Music LLP: R. Hrafnkelsson ||
+ * Coordinated by , A. Reyes-Lecuona (University of Malaga) and L.Picinali (Imperial College London) ||
+ * \b Contact: areyes@uma.es and l.picinali@imperial.ac.uk
+ *
+ * \b Project: 3DTI (3D-games for TUNing and lEarnINg about hearing aids) ||
+ * \b Website: http://3d-tune-in.eu/
+ *
+ * \b Copyright: University of Malaga and Imperial College London - 2026
+ *
+ * \b Licence: This copy of the 3D Tune-In Toolkit Plugin is licensed to you under the terms described in the LICENSE.md file included in this distribution.
+ *
+ * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*  Receives head tracker orientations as OSC messages over UDP on the local
+    machine and keeps the latest one for the audio thread to read.
+
+    Two messages are understood, with angles in degrees and quaternions in
+    the toolkit's axes (x forward, y left, z up):
+
+        /3dti/head/ypr         ,fff    yaw pitch roll
+        /3dti/head/quaternion  ,ffff   w x y z
+
+    The tracked orientation is kept apart from the listener orientation
+    parameters, so hosts don't record it as automation. All instances in a
+    process share one socket, which is open while any of them has its enable
+    parameter on. That parameter is polled on the message thread. If the port
+    is taken by another process, the user is told once and the receiver
+    waits for the parameter to be switched off and on before trying again.
+
+    Messages can also be passed to handleMessage() directly, e.g. with
+    createMessage(), to drive the orientation without a network.
+ */
+class HeadTrackingReceiver  : private Timer
+{
+public:
+    //==========================================================================
+    static constexpr int kDefaultPort = 9050;
+
+    struct Orientation
+    {
+        float yaw   = 0.f;
+        float pitch = 0.f;
+        float roll  = 0.f;
+    };
+
+    //==========================================================================
+    HeadTrackingReceiver (AudioParameterBool& enabled);
+
+    ~HeadTrackingReceiver();
+
+    //==========================================================================
+    /** Applies an OSC message to every instance in the process. Called from
+        the receiving thread, but can be called from any thread.
+
+        @returns false if the message isn't a valid orientation message
+     */
+    bool handleMessage (const void* data, int size);
+
+    /** Reads the latest orientation. Can be called from the audio thread.
+
+        @returns false if tracking is off or nothing has been received yet
+     */
+    bool getOrientation (Orientation& orientation) const;
+
+    /** @returns false if the message isn't a valid orientation message */
+    static bool parseMessage (const void* data, int size, Orientation& orientation);
+
+    /** Encodes an orientation as a /3dti/head/ypr message */
+    static MemoryBlock createMessage (const Orientation& orientation);
+
+private:
+    //==========================================================================
+    /** The socket and latest orientation, shared by the whole process */
+    class SharedSocket  : private Thread
+    {
+    public:
+        SharedSocket();
+        ~SharedSocket();
+
+        /** Opens the socket for the first user.
+
+            @returns false if the port couldn't be bound
+         */
+        bool addUser();
+
+        /** Closes the socket once the last user is gone */
+        void removeUser();
+
+        void setOrientation (const Orientation& orientation);
+
+        /** @returns false if nothing has been received since the socket opened */
+        bool getOrientation (Orientation& orientation) const;
+
+    private:
+        void run() override;
+        void close();
+
+        std::atomic<float> mYaw {0.f}, mPitch {0.f}, mRoll {0.f};
+        std::atomic<bool>  mHasOrientation {false};
+
+        int mNumUsers = 0;
+        std::unique_ptr<DatagramSocket> mSocket;
+    };
+
+    /** Timer, joins or leaves the shared socket to follow the enable parameter */
+    void timerCallback() override;
+
+    //==========================================================================
+    AudioParameterBool& mEnabled;
+
+    SharedResourcePointer<SharedSocket> mShared;
+
+    bool mListening = false;   // Counted as a user of the shared socket
+    bool mPortInUse = false;   // Binding failed, so wait until tracking is switched off
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HeadTrackingReceiver)
+};
@@ -0,0 +1,113 @@
+/**
+ * \class HostParameterSync
+ *
+ * \brief Implementation of HostParameterSync interface.
+ * \date  October 2026
+ *
+ * \authors Reactify Music LLP: R. Hrafnkelsson ||
+ * Coordinated by , A. Reyes-Lecuona (University of Malaga) and L.Picinali (Imperial College London) ||
+ * \b Contact: areyes@uma.es and l.picinali@imperial.ac.uk
+ *
+ * \b Project: 3DTI (3D-games for TUNing and lEarnINg about hearing aids) ||
+ * \b Website: http://3d-tune-in.eu/
+ *
+ * \b Copyright: University of Malaga and Imperial College London - 2026
+ *
+ * \b Licence: This copy of the 3D Tune-In Toolkit Plugin is licensed to you under the terms described in the LICENSE.md file included in this distribution.
+ *
+ * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
+ */
+
+#include "HostParameterSync.h"
+
+//==============================================================================
+// Timer rates while entries are dirty, and while waiting for one to be marked
+static constexpr int kActiveRateHz = 30;
+static constexpr int kIdleRateHz   = 5;
+
+//==============================================================================
+HostParameterSync::HostParameterSync (AudioProcessorValueTreeState& state, AudioProcessorParameter::Listener& listener)
+  : mState (state),
+    mListener (listener)
+{
+    startTimer (1000 / kIdleRateHz);
+}
+
+HostParameterSync::~HostParameterSync()
+{
+    stopTimer();
+    mInternalListeners.clear();
+}
+
+//==============================================================================
+uint32 HostParameterSync::add (const String& parameterID, std::function<float()> getValue)
+{
+    auto* parameter = mState.getParameter (parameterID);
+
+    if (parameter == nullptr)
+    {
+        DBG ("No host parameter named " + parameterID);
+        return 0;
+    }
+
+    // One bit per entry
+    jassert (mEntries.size() < 32);
+
+    mEntries.push_back ({parameterID, parameter, mState.getParameterRange (parameterID), std::move (getValue)});
+
+    auto flag = 1u << (mEntries.size() - 1);
+    markDirty (flag);
+
+    return flag;
+}
+
+uint32 HostParameterSync::add (const String& parameterID, RangedAudioParameter& internalParameter)
+{
+    auto flag = add (parameterID, [&internalParameter]
+    {
+        return internalParameter.convertFrom0to1 (internalParameter.getValue());
+    });
+
+    if (flag != 0)
+        mInternalListeners.add (new InternalListener (*this, internalParameter, flag));
+
+    return flag;
+}
+
+//==============================================================================
+void HostParameterSync::markDirty (uint32 flags)
+{
+    mDirty.fetch_or (flags);
+}
+
+void HostParameterSync::timerCallback()
+{
+    auto dirty = mDirty.exchange (0);
+
+    // Stay responsive while values are changing, e.g. during a drag
+    auto interval = 1000 / (dirty != 0 ? kActiveRateHz : kIdleRateHz);
+
+    if (getTimerInterval() != interval)
+        startTimer (interval);
+
+    for (size_t i = 0; i < mEntries.size() && dirty != 0; ++i, dirty >>= 1)
+    {
+        if ((dirty & 1) == 0)
+            continue;
+
+        auto const& entry = mEntries[i];
+        auto value = entry.getValue();
+
+        if (value < entry.range.start || value > entry.range.end)
+            continue;
+
+        auto newValue = entry.range.convertTo0to1 (value);
+
+        if (std::abs (entry.parameter->getValue() - newValue) > std::numeric_limits<float>::epsilon())
+        {
+            entry.parameter->removeListener (&mListener);
+            entry.parameter->setValueNotifyingHost (newValue);
+            entry.parameter->addListener (&mListener);
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/**
+ * \class HostParameterSync
+ *
+ * \brief Declaration of HostParameterSync interface.
+ * \date  October 2026
+ *
+ * \authors Reactify Music LLP: R. Hrafnkelsson ||
+ * Coordinated by , A. Reyes-Lecuona (University of Malaga) and L.Picinali (Imperial College London) ||
+ * \b Contact: areyes@uma.es and l.picinali@imperial.ac.uk
+ *
+ * \b Project: 3DTI (3D-games for TUNing and lEarnINg about hearing aids) ||
+ * \b Website: http://3d-tune-in.eu/
+ *
+ * \b Copyright: University of Malaga and Imperial College London - 2026
+ *
+ * \b Licence: This copy of the 3D Tune-In Toolkit Plugin is licensed to you under the terms described in the LICENSE.md file included in this distribution.
+ *
+ * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*  Keeps host parameters in line with processor state that the editor
+    changes directly, e.g. the source position or the internal parameters
+    of AnechoicProcessor and ReverbProcessor.
+
+    Each mirrored value has a dirty bit. Marking one only sets the bit, so it
+    is safe on the audio thread. A timer on the message thread drains the
+    bits and visits only the dirty entries. It runs at the refresh rate
+    while bits are set and falls back to a slow poll once they're clear.
+ */
+class HostParameterSync  : private Timer
+{
+public:
+    //==========================================================================
+    /** The listener is detached from a host parameter while it is being
+        updated, so the change isn't applied to the processor a second time.
+     */
+    HostParameterSync (AudioProcessorValueTreeState& state, AudioProcessorParameter::Listener& listener);
+
+    ~HostParameterSync();
+
+    //==========================================================================
+    /** Mirrors a value read by getValue. Pass the returned flag to markDirty()
+        whenever that value changes.
+
+        @returns the entry's dirty flag, or 0 if there is no such host parameter
+     */
+    uint32 add (const String& parameterID, std::function<float()> getValue);
+
+    /** Mirrors an internal parameter, which marks itself dirty when it changes */
+    uint32 add (const String& parameterID, RangedAudioParameter& internalParameter);
+
+    //==========================================================================
+    /** Schedules the given entries to be pushed to the host. Can be called
+        from any thread and never blocks or allocates.
+     */
+    void markDirty (uint32 flags);
+
+    void markAllDirty() { markDirty (~0u); }
+
+private:
+    //==========================================================================
+    struct Entry
+    {
+        String                  parameterID;
+        RangedAudioParameter*   parameter;
+        NormalisableRange<float> range;
+        std::function<float()>  getValue;
+    };
+
+    /** Marks an entry dirty whenever an internal parameter changes */
+    struct InternalListener  : private AudioProcessorParameter::Listener
+    {
+        InternalListener (HostParameterSync& o, AudioProcessorParameter& p, uint32 f)
+          : owner (o), parameter (p), flag (f)
+        {
+            parameter.addListener (this);
+        }
+
+        ~InternalListener() override
+        {
+            parameter.removeListener (this);
+        }
+
+        void parameterValueChanged (int, float) override { owner.markDirty (flag); }
+        void parameterGestureChanged (int, bool) override {}
+
+        HostParameterSync&       owner;
+        AudioProcessorParameter& parameter;
+        const uint32             flag;
+    };
+
+    //==========================================================================
+    /** Timer */
+    void timerCallback() override;
+
+    //==========================================================================
+    AudioProcessorValueTreeState&      mState;
+    AudioProcessorParameter::Listener& mListener;
+
+    std::vector<Entry>           mEntries;
+    OwnedArray<InternalListener> mInternalListeners;
+    std::atomic<uint32>          mDirty {0};
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HostParameterSync)
+};
@@ -0,0 +1,211 @@
+/**
+ * \class IntegerResampler
+ *
+ * \brief Implementation of IntegerResampler interface.
+ * \date  October 2026
+ *
+ * \authors Reactify Music LLP: R. Hrafnkelsson ||
+ * Coordinated by , A. Reyes-Lecuona (University of Malaga) and L.Picinali (Imperial College London) ||
+ * \b Contact: areyes@uma.es and l.picinali@imperial.ac.uk
+ *
+ * \b Project: 3DTI (3D-games for TUNing and lEarnINg about hearing aids) ||
+ * \b Website: http://3d-tune-in.eu/
+ *
+ * \b Copyright: University of Malaga and Imperial College London - 2026
+ *
+ * \b Licence: This copy of the 3D Tune-In Toolkit Plugin is licensed to you under the terms described in the LICENSE.md file included in this distribution.
+ *
+ * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
+ */
+
+#include "Utils.h"
+#include "IntegerResampler.h"
+
+// Filter length per output phase, i.e. in samples at the toolkit rate
+static constexpr int kTapsPerPhase = 48;
+
+static constexpr int kMaxFactor = 8;
+
+// Kaiser window shape, roughly 80 dB of stop band attenuation
+static constexpr double kKaiserBeta = 8.0;
+
+static double besselI0 (double x)
+{
+    double sum  = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum  += term;
+    }
+
+    return sum;
+}
+
+//==============================================================================
+double IntegerResampler::getProcessingSampleRate (double hostSampleRate)
+{
+    auto hasResources = [] (double sampleRate)
+    {
+        return sampleRate == std::floor (sampleRate)
+            && SampleRateToDefaultHRTF_ILD.count ((int)sampleRate) > 0;
+    };
+
+    if (hasResources (hostSampleRate))
+        return hostSampleRate;
+
+    // Prefer the highest resource rate the host rate is a multiple of
+    for (int factor = 2; factor <= kMaxFactor; ++factor)
+    {
+        if (hasResources (hostSampleRate / factor))
+            return hostSampleRate / factor;
+    }
+
+    return hostSampleRate;
+}
+
+//==============================================================================
+void IntegerResampler::prepare (int numChannels, int factor)
+{
+    jassert (factor >= 1 && factor <= kMaxFactor);
+
+    mFactor = factor;
+    mPhase  = 0;
+    mWritePosition = 0;
+
+    mCoefficients.clear();
+    mHistory.setSize (numChannels, 0);
+
+    if (factor == 1)
+        return;
+
+    // Windowed sinc low pass, cut off just below the toolkit's Nyquist frequency
+    const int numTaps = kTapsPerPhase * factor;
+    const double cutoff = 0.45 / factor;
+    const double centre = (numTaps - 1) * 0.5;
+
+    mCoefficients.resize (numTaps);
+
+    double sum = 0.0;
+
+    for (int n = 0; n < numTaps; ++n)
+    {
+        double t = n - centre;
+        double sinc = 2.0 * cutoff * (t == 0.0 ? 1.0 : std::sin (MathConstants<double>::twoPi * cutoff * t)
+                                                      / (MathConstants<double>::twoPi * cutoff * t));
+
+        double x = (n - centre) / centre;
+        double window = besselI0 (kKaiserBeta * std::sqrt (std::max (0.0, 1.0 - x * x))) / besselI0 (kKaiserBeta);
+
+        mCoefficients[n] = (float)(sinc * window);
+        sum += mCoefficients[n];
+    }
+
+    for (auto& coefficient : mCoefficients)
+        coefficient = (float)(coefficient / sum);
+
+    // The history is written twice so the filter always reads a contiguous window
+    mHistory.setSize (numChannels, 2 * numTaps);
+    mHistory.clear();
+}
+
+int IntegerResampler::getLatencySamples() const
+{
+    return mFactor > 1 ? ((int)mCoefficients.size() - 1) / 2 : 0;
+}
+
+//==============================================================================
+int IntegerResampler::downsample (const AudioBuffer<float>& input, int numSamples, AudioBuffer<float>& output)
+{
+    const int numChannels = mHistory.getNumChannels();
+
+    if (mFactor == 1)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            output.copyFrom (ch, 0, input, ch, 0, numSamples);
+
+        return numSamples;
+    }
+
+    const int length = (int)mCoefficients.size();
+
+    int numOut = 0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        pushSample (input, i, length);
+
+        if (++mPhase < mFactor)
+            continue;
+
+        mPhase = 0;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* window = mHistory.getReadPointer (ch, mWritePosition);
+
+            float sum = 0.f;
+
+            for (int k = 0; k < length; ++k)
+                sum += mCoefficients[k] * window[k];
+
+            output.setSample (ch, numOut, sum);
+        }
+
+        ++numOut;
+    }
+
+    return numOut;
+}
+
+void IntegerResampler::upsample (const AudioBuffer<float>& input, int numSamples, AudioBuffer<float>& output)
+{
+    const int numChannels = mHistory.getNumChannels();
+
+    if (mFactor == 1)
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            output.copyFrom (ch, 0, input, ch, 0, numSamples);
+
+        return;
+    }
+
+    // Polyphase form: each input sample yields one output per phase,
+    // using every factor-th coefficient against the zero stuffed signal
+    const int length = kTapsPerPhase;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        pushSample (input, i, length);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* newest = mHistory.getReadPointer (ch, mWritePosition + length - 1);
+            float* out = output.getWritePointer (ch, i * mFactor);
+
+            for (int phase = 0; phase < mFactor; ++phase)
+            {
+                float sum = 0.f;
+
+                for (int j = 0; j < length; ++j)
+                    sum += mCoefficients[phase + j * mFactor] * newest[-j];
+
+                out[phase] = sum * mFactor;
+            }
+        }
+    }
+}
+
+//==============================================================================
+void IntegerResampler::pushSample (const AudioBuffer<float>& input, int sample, int length)
+{
+    for (int ch = 0; ch < mHistory.getNumChannels(); ++ch)
+    {
+        float value = input.getSample (ch, sample);
+        mHistory.setSample (ch, mWritePosition, value);
+        mHistory.setSample (ch, mWritePosition + length, value);
+    }
+
+    mWritePosition = (mWritePosition + 1) % length;
+}
@@ -0,0 +1,74 @@
+/**
+ * \class IntegerResampler
+ *
+ * \brief Declaration of IntegerResampler interface.
+ * \date  October 2026
+ *
+ * \authors Reactify Music LLP: R. Hrafnkelsson ||
+ * Coordinated by , A. Reyes-Lecuona (University of Malaga) and L.Picinali (Imperial College London) ||
+ * \b Contact: areyes@uma.es and l.picinali@imperial.ac.uk
+ *
+ * \b Project: 3DTI (3D-games for TUNing and lEarnINg about hearing aids) ||
+ * \b Website: http://3d-tune-in.eu/
+ *
+ * \b Copyright: University of Malaga and Imperial College London - 2026
+ *
+ * \b Licence: This copy of the 3D Tune-In Toolkit Plugin is licensed to you under the terms described in the LICENSE.md file included in this distribution.
+ *
+ * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*  Converts audio between the host sample rate and the rate the toolkit runs at.
+
+    HRTF, BRIR and ILD resources only exist for a few sample rates. Sessions
+    running at an integer multiple of one of them (e.g. 88.2 or 192 kHz) are
+    processed at the resource rate, with the audio decimated on the way in
+    and interpolated on the way out. Use one instance per direction.
+ */
+class IntegerResampler
+{
+public:
+    //==========================================================================
+    /** @returns the sample rate the toolkit should run at. This is the host
+                 rate itself unless there are no resources for it.
+     */
+    static double getProcessingSampleRate (double hostSampleRate);
+
+    //==========================================================================
+    /** Designs the low pass filter and allocates its history.
+        A factor of 1 passes samples through unchanged.
+     */
+    void prepare (int numChannels, int factor);
+
+    int getFactor() const { return mFactor; }
+
+    /** @returns the delay added by the filter, in samples at the host rate */
+    int getLatencySamples() const;
+
+    //==========================================================================
+    /** Filters and decimates numSamples of input into output.
+
+        @returns the number of samples written, at most numSamples / factor + 1
+     */
+    int downsample (const AudioBuffer<float>& input, int numSamples, AudioBuffer<float>& output);
+
+    /** Interpolates numSamples of input into numSamples * factor samples of output */
+    void upsample (const AudioBuffer<float>& input, int numSamples, AudioBuffer<float>& output);
+
+private:
+    //==========================================================================
+    void pushSample (const AudioBuffer<float>& input, int sample, int length);
+
+    //==========================================================================
+    int mFactor = 1;
+    int mPhase  = 0;
+    int mWritePosition = 0;
+
+    std::vector<float> mCoefficients;
+    AudioBuffer<float> mHistory;
+};
@@ -23,7 +23,8 @@
 //==============================================================================
 ReverbControls::ReverbControls (ReverbProcessor& p)
   : mReverb (p),
-    gainLabel("Level Label", "Level [dB]")
+    gainLabel("Level Label", "Level [dB]"),
+    levelMeter (p.getLevelMeter())
 {
     brirMenu.addItemList (mReverb.getBRIROptions(), 1);
     brirMenu.onChange = [this] { brirMenuChanged(); };
@@ -40,6 +41,8 @@ ReverbControls::ReverbControls (ReverbProcessor& p)
     gainSlider.addListener (this);
     addAndMakeVisible (gainSlider);
     
+    addAndMakeVisible (levelMeter);
+    
     bypassToggle.setButtonText ("On/Off");
     bypassToggle.setToggleState (true, dontSendNotification);
     bypassToggle.onClick = [this] { mReverb.reverbEnabled = bypassToggle.getToggleState(); };
@@ -76,6 +79,7 @@ void ReverbControls::resized()
     brirMenu.setBounds (12, 40, area.getWidth()-24, 22);
     gainLabel.setBounds (10, brirMenu.getBottom() + 16, area.getWidth()-20, 24);
     gainSlider.setBounds (6, gainLabel.getBottom(), area.getWidth()-18, 24);
+    levelMeter.setBounds (12, gainSlider.getBottom() + 4, area.getWidth()-24, 12);
 }
 
 //==============================================================================
@@ -83,6 +87,7 @@ void ReverbControls::updateGui()
 {
     updateBypass();
     gainSlider.setValue (mReverb.reverbLevel.get(), dontSendNotification);
+    levelMeter.updateGui();
 }
 
 void ReverbControls::updateBypass()
@@ -23,6 +23,7 @@
 #include <JuceHeader.h>
 #include "ReverbProcessor.h"
 #include "Utils.h"
+#include "Common/LevelMeter.h"
 
 //==============================================================================
 /*
@@ -77,6 +78,7 @@ private:
     ComboBox brirMenu;
     Label gainLabel;
     Slider gainSlider;
+    LevelMeterComponent levelMeter;
     std::unique_ptr<FileChooser> fc;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReverbControls)
@@ -27,6 +27,8 @@ ReverbPluginProcessorEditor::ReverbPluginProcessorEditor (ReverbPluginProcessor&
     : AudioProcessorEditor(&p)
     , processor(p)
     , reverbControls (p.getReverbProcessor())
+    , outputMeter (p.getOutputMeter())
+    , refreshScheduler (*this, [this] { updateGui(); })
 {
     setOpaque (true);
     
@@ -42,15 +44,13 @@ ReverbPluginProcessorEditor::ReverbPluginProcessorEditor (ReverbPluginProcessor&
     
     addAndMakeVisible (aboutBanner);
     addAndMakeVisible (reverbControls);
+    addAndMakeVisible (outputMeter);
     addChildComponent (aboutText);
     
-    setSize (600, 200);
-
-    startTimer (30);
+    setSize (600, 216);
 }
 
 ReverbPluginProcessorEditor::~ReverbPluginProcessorEditor() {
-  stopTimer();
 }
 
 //==============================================================================
@@ -64,12 +64,14 @@ void ReverbPluginProcessorEditor::resized()
     auto r = getLocalBounds();
   
     aboutBanner.setBounds (r.removeFromTop (50));
+    outputMeter.setBounds (r.removeFromBottom (16).reduced (12, 2));
     reverbControls.setBounds (r);
     aboutText.setBounds(r);
 }
 
 //==============================================================================
-void ReverbPluginProcessorEditor::timerCallback()
+void ReverbPluginProcessorEditor::updateGui()
 {
     reverbControls.updateGui();
+    outputMeter.updateGui();
 }
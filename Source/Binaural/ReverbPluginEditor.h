@@ -22,13 +22,14 @@
 
 #include <JuceHeader.h>
 #include "Common/AboutBanner.h"
+#include "Common/RefreshScheduler.h"
 #include "ReverbControls.h"
 #include "ReverbPluginProcessor.h"
 
 //==============================================================================
 /**
 */
-class ReverbPluginProcessorEditor : public AudioProcessorEditor, public Timer
+class ReverbPluginProcessorEditor : public AudioProcessorEditor
 {
 public:
   ReverbPluginProcessorEditor (ReverbPluginProcessor&);
@@ -38,7 +39,7 @@ public:
   void paint (Graphics&) override;
   void resized() override;
   
-  void timerCallback() override;
+  void updateGui();
   
   void mouseDown(const MouseEvent &e) override {
     aboutText.setVisible(false);
@@ -50,8 +51,11 @@ private:
 
   AboutBanner aboutBanner;
   ReverbControls reverbControls;
+  LevelMeterComponent outputMeter;
 
   TextEditor aboutText;
 
+  RefreshScheduler refreshScheduler;
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReverbPluginProcessorEditor)
 };
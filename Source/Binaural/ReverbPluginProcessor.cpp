@@ -18,6 +18,7 @@
 * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
 */
 
+#include "Common/PluginState.h"
 #include "ReverbPluginProcessor.h"
 #include "ReverbPluginEditor.h"
 
@@ -55,16 +56,22 @@ ReverbPluginProcessor::ReverbPluginProcessor()
     using Parameter = AudioProcessorValueTreeState::Parameter;
     
     addBooleanHostParameter (treeState, "Reverb Enabled", getReverbProcessor().reverbEnabled);
-    treeState.addParameterListener ("Reverb Enabled", this);
     
     treeState.createAndAddParameter (std::make_unique<Parameter> ("Reverb Level", "Reverb Level", "", getReverbProcessor().reverbLevel.range, getReverbProcessor().reverbLevel.get(), nullptr, nullptr));
-    treeState.addParameterListener ("Reverb Level", this);
   
     treeState.createAndAddParameter (std::make_unique<Parameter> ("BRIR", "BRIR", "", NormalisableRange<float>(0, BundledBRIRs.size()-1), 0, [](float value) { return String (value, 0); }, nullptr));
-    treeState.addParameterListener ("BRIR", this);
+    
+    // Changes are dispatched by parameter index, which is the creation order
+    jassert (getParameters().size() == kNumParameters);
+    jassert (treeState.getParameter ("BRIR")->getParameterIndex() == kBRIR);
+    
+    for (auto* parameter : getParameters())
+        parameter->addListener (this);
     
     treeState.state = ValueTree("3DTI Reverb Parameters");
     
+    setUpHostSync();
+    
 #if DEBUG
     ERRORHANDLER3DTI.SetVerbosityMode(VERBOSITYMODE_ERRORSANDWARNINGS);
     ERRORHANDLER3DTI.SetErrorLogStream(&std::cout, true);
@@ -143,11 +150,23 @@ void ReverbPluginProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
   const int blockSizeInternal = kTOOLKIT_BUFFER_SIZE;
     
   auto numSideChainInputs = getChannelCountOfBus (true, 1);
+  
+  // Resources only exist for some sample rates, sessions running
+  // at a multiple of one of those are processed at that rate
+  const double processingSampleRate = IntegerResampler::getProcessingSampleRate (sampleRate);
+  const int factor = roundToInt (sampleRate / processingSampleRate);
+  
+  downsampler.prepare (numSideChainInputs, factor);
+  upsampler.prepare (2, factor);
+  
+  downsampledQuad.setSize (numSideChainInputs, samplesPerBlock);
+  reverb.setSize (2, samplesPerBlock);
+  upsampledStereo.setSize (2, blockSizeInternal * factor);
         
   inFifo.setSize (numSideChainInputs, std::max (blockSizeInternal, samplesPerBlock) + 1);
   inFifo.clear();
   
-  outFifo.setSize (2, std::max (samplesPerBlock, blockSizeInternal) * 2);
+  outFifo.setSize (2, std::max (samplesPerBlock, blockSizeInternal * factor) * 2);
   outFifo.clear();
    
   scratchBufferStereo.setSize (2, blockSizeInternal);
@@ -156,11 +175,13 @@ void ReverbPluginProcessor::prepareToPlay (double sampleRate, int samplesPerBloc
   scratchBufferQuad.setSize (numSideChainInputs, blockSizeInternal);
   scratchBufferQuad.clear();
     
-  mCore.SetAudioState ({(int)sampleRate, blockSizeInternal});
+  setLatencySamples (downsampler.getLatencySamples() + upsampler.getLatencySamples());
     
-  mReverb.setup (sampleRate, blockSizeInternal);
+  mCore.SetAudioState ({(int)processingSampleRate, blockSizeInternal});
+    
+  mReverb.setup (processingSampleRate, blockSizeInternal);
   
-  // startTimer(30);
+  mOutputMeter.prepare (sampleRate, 2);
 }
 
 void ReverbPluginProcessor::releaseResources() {
@@ -201,7 +222,13 @@ void ReverbPluginProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer
     // Some hosts send buffers of varying sizes so we maintain
     // an internal buffer to pass the correct size to the 3dti core
     
-    inFifo.addToFifo (reverbInputs);
+    // Only reallocates if the host exceeds the block size it announced
+    downsampledQuad.setSize (downsampledQuad.getNumChannels(), numSamples, false, false, true);
+    reverb.setSize (2, numSamples, false, false, true);
+    
+    int numDownsampled = downsampler.downsample (reverbInputs, numSamples, downsampledQuad);
+    
+    inFifo.addToFifo (downsampledQuad, numDownsampled);
 
     while (inFifo.getNumReady() >= blockSizeInternal)
     {
@@ -209,7 +236,8 @@ void ReverbPluginProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer
         
         inFifo.readFromFifo (scratchBufferQuad, blockSizeInternal);
         mReverb.process (scratchBufferQuad, scratchBufferStereo);
-        outFifo.addToFifo (scratchBufferStereo);
+        upsampler.upsample (scratchBufferStereo, blockSizeInternal, upsampledStereo);
+        outFifo.addToFifo (upsampledStereo);
     }
 
     int numReady = outFifo.getNumReady();
@@ -223,11 +251,12 @@ void ReverbPluginProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuffer
         setLatencySamples (latency);
     }
     
-    AudioSampleBuffer reverb (mainInput.getNumChannels(), numSamples);
-    outFifo.readFromFifo (reverb);
+    outFifo.readFromFifo (reverb, numSamples);
     
     for (int ch = 0; ch < mainInput.getNumChannels(); ch++)
         mainInput.addFrom (ch, 0, reverb, ch, 0, numSamples);
+    
+    mOutputMeter.process (mainInput, numSamples);
 }
 
 //==============================================================================
@@ -244,46 +273,64 @@ AudioProcessorEditor* ReverbPluginProcessor::createEditor()
 //==============================================================================
 void ReverbPluginProcessor::getStateInformation (MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    auto state = treeState.copyState();
+    
+    state.setProperty ("BRIRPath", mReverb.getBRIRPath().getFullPathName(), nullptr);
+    state.setProperty ("ReverbOrder", mReverb.reverbOrder.get(), nullptr);
+    
+    PluginState::write (state, destData);
 }
 
 void ReverbPluginProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    auto state = PluginState::read (data, sizeInBytes);
+    
+    if (! state.hasType (treeState.state.getType()))
+        return;
+    
+    // Apply the whole state before the next block is processed
+    suspendProcessing (true);
+    
+    // The BRIR parameter would trigger a load of its own, so the
+    // selected file is restored explicitly and loaded only once
+    getParameters()[kBRIR]->removeListener (this);
+    treeState.replaceState (state);
+    getParameters()[kBRIR]->addListener (this);
+    
+    mReverb.reverbOrder = (int)state.getProperty ("ReverbOrder", mReverb.reverbOrder.get());
+    mReverb.restoreBRIR (File (state["BRIRPath"].toString()));
+    
+    suspendProcessing (false);
 }
 
-void ReverbPluginProcessor::updateHostParameters()
+void ReverbPluginProcessor::setUpHostSync()
 {
-    std::unordered_map<String, float> parameters = {
-      {"Reverb Enabled", getReverbProcessor().reverbEnabled},
-      {"Reverb Level", getReverbProcessor().reverbLevel},
-      {"BRIR", getReverbProcessor().reverbBRIR.get() },
-    };
+    hostSync.add ("Reverb Enabled", mReverb.reverbEnabled);
+    hostSync.add ("Reverb Level",   mReverb.reverbLevel);
+    hostSync.add ("BRIR",           mReverb.reverbBRIR);
+}
 
-    for ( auto const & parameter : parameters )
-    {
-        if ( AudioProcessorParameter* p = treeState.getParameter(parameter.first) )
-        {
-            const float newValue = treeState.getParameterRange(parameter.first).convertTo0to1(parameter.second);
-      
-            if ( fabs(p->getValue() - newValue) > std::numeric_limits<float>::epsilon() )
-                p->setValueNotifyingHost(newValue);
-        }
-    }
+void ReverbPluginProcessor::parameterValueChanged (int parameterIndex, float newValue)
+{
+    auto* parameter = static_cast<RangedAudioParameter*> (getParameters().getUnchecked (parameterIndex));
+    parameterChanged ((ParameterIndex)parameterIndex, parameter->convertFrom0to1 (newValue));
 }
 
-void ReverbPluginProcessor::parameterChanged(const String& parameterID, float newValue)
+void ReverbPluginProcessor::parameterChanged (ParameterIndex parameter, float newValue)
 {
-    DBG ("Changing Parameter: " + parameterID);
-    if ( parameterID == "Reverb Enabled" ) {
-        mReverb.reverbEnabled = (bool)newValue;
-    } else if ( parameterID == "Reverb Level" ) {
-        mReverb.reverbLevel = newValue;
-    } else if ( parameterID == "BRIR" ) {
-        mReverb.reverbBRIR = roundToInt (newValue);
+    switch (parameter)
+    {
+        case kReverbEnabled:
+            mReverb.reverbEnabled = (bool)newValue;
+            break;
+        case kReverbLevel:
+            mReverb.reverbLevel = newValue;
+            break;
+        case kBRIR:
+            mReverb.reverbBRIR = roundToInt (newValue);
+            break;
+        default:
+            break;
     }
 }
 
@@ -23,6 +23,8 @@
 #include <JuceHeader.h>
 #include <ff_buffers/ff_buffers_AudioBufferFIFO.h>
 #include "ReverbProcessor.h"
+#include "IntegerResampler.h"
+#include "HostParameterSync.h"
 
 //==============================================================================
 /**
@@ -31,8 +33,7 @@
 using CSingleSourceRef = std::shared_ptr<Binaural::CSingleSourceDSP>;
 
 class ReverbPluginProcessor  : public AudioProcessor
-                             , private AudioProcessorValueTreeState::Listener
-                             , private Timer
+                             , private AudioProcessorParameter::Listener
 {
 public:
   //============================================================================
@@ -75,25 +76,43 @@ public:
   //============================================================================
   ReverbProcessor&   getReverbProcessor() { return mReverb; }
   
+  /** Measures the main output, at the host sample rate */
+  LevelMeter&        getOutputMeter()     { return mOutputMeter; }
+  
   AudioProcessorValueTreeState treeState;
   
 private:
     //==========================================================================
-  void timerCallback() override
+  /** Host parameters, in the order they are created */
+  enum ParameterIndex
   {
-  }
+    kReverbEnabled,
+    kReverbLevel,
+    kBRIR,
+    kNumParameters
+  };
+  
+  void setUpHostSync();
   
-  void updateHostParameters();
+  /** AudioProcessorParameter::Listener */
+  void parameterValueChanged (int parameterIndex, float newValue) override;
+  void parameterGestureChanged (int, bool) override {}
   
-  void parameterChanged(const String& parameterID, float newValue) override;
+  void parameterChanged (ParameterIndex parameter, float newValue);
     
   AudioBuffer<float>     scratchBufferStereo, scratchBufferQuad;
+  AudioBuffer<float>     downsampledQuad, upsampledStereo, reverb;
+  IntegerResampler       downsampler, upsampler;
   AudioBufferFIFO<float> inFifo, outFifo;
    
   //============================================================================
   Binaural::CCore mCore;
   ReverbProcessor mReverb {mCore};
   
+  HostParameterSync hostSync {treeState, *this};
+  
+  LevelMeter mOutputMeter;
+  
   //==============================================================================
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReverbPluginProcessor)
 };
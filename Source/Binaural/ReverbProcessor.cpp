@@ -46,7 +46,23 @@ ReverbProcessor::~ReverbProcessor()
 //==============================================================================
 void ReverbProcessor::setup (double sampleRate, int samplesPerBlock)
 {
-    loadBRIR (getBundledBRIR (reverbBRIR.get(), sampleRate));
+    // Bundled BRIRs are swapped for the version matching the
+    // sample rate, custom files are reloaded as they are
+    File brir = mBRIRPath;
+    int index = brirPathToBundledIndex (brir);
+    
+    if (! brir.existsAsFile() || index >= 0)
+    {
+        if (index < 0)
+            index = reverbBRIR.get() < BundledBRIRs.size() ? reverbBRIR.get() : 0;
+        
+        brir = getBundledBRIR (index, sampleRate);
+    }
+    
+    mSampleRate = sampleRate;
+    mMeter.prepare (sampleRate, 2);
+    
+    loadBRIR (brir);
 }
 
 //==============================================================================
@@ -85,7 +101,7 @@ void ReverbProcessor::process (AudioBuffer<float>& buffer)
     auto reverbGain  = Decibels::decibelsToGain (reverbLevel.get());
     buffer.applyGain (reverbGain);
     
-    mPower = outputBuffer.left.GetPower();
+    mMeter.process (buffer, buffer.getNumSamples());
 }
 
 void ReverbProcessor::process (AudioBuffer<float>& quadIn, AudioBuffer<float>& stereoOut)
@@ -133,7 +149,7 @@ void ReverbProcessor::process (AudioBuffer<float>& quadIn, AudioBuffer<float>& s
     auto reverbGain = Decibels::decibelsToGain (reverbLevel.get());
     stereoOut.applyGain (reverbGain);
     
-    mPower = stereoOut.getRMSLevel (0, 0, numSamples);
+    mMeter.process (stereoOut, numSamples);
 }
 
 //==============================================================================
@@ -194,6 +210,14 @@ void ReverbProcessor::parameterGestureChanged (int parameterIndex, bool gestureI
 //==============================================================================
 bool ReverbProcessor::loadBRIR (const File& file)
 {
+    // Long BRIRs take a while to parse and partition, so
+    // reselecting the one already loaded is a no-op
+    if (file == mBRIRPath && getSampleRate() == mBRIRSampleRate)
+    {
+        resetBRIRIndex();
+        return true;
+    }
+    
     isLoading.store (true);
     
     DBG ("Loading BRIR: " << file.getFullPathName());
@@ -213,10 +237,7 @@ bool ReverbProcessor::loadBRIR (const File& file)
     
     if (fileSampleRate != getSampleRate())
     {
-        AlertWindow::showMessageBoxAsync (AlertWindow::WarningIcon,
-                                          "Wrong sample rate",
-                                          "Please select a file that matches the project sample rate",
-                                          "OK");
+        showWrongSampleRateAlert (fileSampleRate, (int)getSampleRate());
         resetBRIRIndex();
         
         isLoading.store (false);
@@ -233,6 +254,7 @@ bool ReverbProcessor::loadBRIR (const File& file)
                : BRIR::CreateFrom3dti (path, mEnvironment))
     {
         mBRIRPath = file;
+        mBRIRSampleRate = getSampleRate();
         
         resetBRIRIndex();
         
@@ -244,16 +266,56 @@ bool ReverbProcessor::loadBRIR (const File& file)
     return success;
 }
 
+void ReverbProcessor::restoreBRIR (const File& file)
+{
+    if (file == File() || file == mBRIRPath)
+        return;
+    
+    auto brir  = file;
+    int  index = brirPathToBundledIndex (brir);
+    
+    // Bundled BRIRs are matched by name, as they may be installed somewhere
+    // else on this machine or saved at another sample rate. A missing custom
+    // file falls back to the default.
+    if (index >= 0)
+    {
+        brir = getBundledBRIR (index, mSampleRate);
+    }
+    else if (! brir.existsAsFile())
+    {
+        showMissingResourceAlert ("BRIR", brir);
+        brir = getBundledBRIR (0, mSampleRate);
+    }
+    
+    if (brir == mBRIRPath)
+        return;
+    
+    if (mSampleRate > 0.0)
+    {
+        loadBRIR (brir);
+    }
+    else
+    {
+        mBRIRPath = brir;
+        resetBRIRIndex();
+    }
+}
+
 //==============================================================================
 void ReverbProcessor::resetBRIRIndex()
 {
     int selectedIndex = brirPathToBundledIndex (getBRIRPath());
     
+    // Only reflect the loaded file, don't trigger another load
+    reverbBRIR.removeListener (this);
+    
     if (selectedIndex >= 0)
         reverbBRIR = selectedIndex;
     else
         reverbBRIR = reverbBRIR.getRange().getEnd() - 1;
     
+    reverbBRIR.addListener (this);
+    
     sendChangeMessage();
 }
 
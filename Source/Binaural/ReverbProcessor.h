@@ -22,6 +22,7 @@
 
 #include <BinauralSpatializer/3DTI_BinauralSpatializer.h>
 #include <JuceHeader.h>
+#include "Common/LevelMeter.h"
 
 //==============================================================================
 class ReverbProcessor  : public  ChangeBroadcaster,
@@ -53,11 +54,19 @@ public:
      */
     bool loadBRIR (const File& file);
     
+    /** Restores a previously selected BRIR. Before setup() has been called the
+        file is only remembered, so that setup() loads it exactly once.
+        
+        If the file is missing, the bundled BRIR of the same name is used, or
+        the default one after telling the user. The BRIR index follows either way.
+     */
+    void restoreBRIR (const File& file);
+    
     /** @returns the file path of the currently loaded BRIR */
     const File&     getBRIRPath() const { return mBRIRPath;  }
     
-    /***/
-    float           getPower()     const { return mPower; };
+    /** Measures the reverb output */
+    LevelMeter&     getLevelMeter()      { return mMeter; }
     
     //==========================================================================
     /** Public parameters */
@@ -93,13 +102,16 @@ private:
     //==========================================================================
     std::atomic<bool> isLoading {false};
     
+    double mSampleRate = 0.0;
+    double mBRIRSampleRate = 0.0;
+    
     Binaural::CCore& mCore;
     std::shared_ptr<Binaural::CEnvironment> mEnvironment;
     
     File mBRIRPath;
     std::unique_ptr<FileChooser> fc;
     
-    float mPower;
+    LevelMeter mMeter;
     
     JUCE_DECLARE_WEAK_REFERENCEABLE (ReverbProcessor)
 };
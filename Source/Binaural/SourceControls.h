@@ -105,7 +105,7 @@ public:
   }
     
   void updateGui() {
-    auto position = mCore.getSourcePosition(0);
+    auto position = mCore.getSourcePosition();
     distanceSlider.setValue(position.GetDistance(), dontSendNotification);
     azimuthSlider.setValue (AzimuthMapper::fromToolkit (position.GetAzimuthDegrees()), dontSendNotification);
     elevationSlider.setValue(mapElevationToSliderValue(position.GetElevationDegrees()), dontSendNotification);
@@ -135,9 +135,7 @@ public:
   }
   
   void sliderValueChanged( Slider* slider ) override {
-    auto source = mCore.getSources().front();
-      
-    auto position = mCore.getSourcePosition(source);
+    auto position = mCore.getSourcePosition();
     
     if (slider == &azimuthSlider)
     {
@@ -156,7 +154,7 @@ public:
       position.z = slider->getValue();
     }
     
-    mCore.setSourcePosition(source, position);
+    mCore.setSourcePosition(position);
     
     repaint();
     updateGui();
@@ -29,7 +29,9 @@ Toolkit3dtiPluginAudioProcessorEditor::Toolkit3dtiPluginAudioProcessorEditor (To
       sourceControls (p.getCore()),
       reverbControls (p),
       anechoicControls (p.getCore(), p.treeState),
-      spatializerWidget (p.getCore())
+      spatializerWidget (p.getCore()),
+      outputMeter (p.getOutputMeter()),
+      refreshScheduler (*this, [this] { updateGui(); })
 {
   // Make sure that before the constructor has finished, you've set the
   // editor's size to whatever you need it to be.
@@ -39,6 +41,7 @@ Toolkit3dtiPluginAudioProcessorEditor::Toolkit3dtiPluginAudioProcessorEditor (To
   addAndMakeVisible (reverbControls);
   addAndMakeVisible (anechoicControls);
   addAndMakeVisible (spatializerWidget);
+  addAndMakeVisible (outputMeter);
   addAndMakeVisible (aboutText);
   addAndMakeVisible (aboutButton);
   addAndMakeVisible (toolkitVersionLabel);
@@ -60,12 +63,9 @@ Toolkit3dtiPluginAudioProcessorEditor::Toolkit3dtiPluginAudioProcessorEditor (To
   
   toolkitVersionLabel.setFont(Font(15.f, Font::plain));
   toolkitVersionLabel.setText("Version " +  String(JucePlugin_VersionString) + " (3DTI Toolkit v1.4)", dontSendNotification);
-
-  startTimer(30);
 }
 
 Toolkit3dtiPluginAudioProcessorEditor::~Toolkit3dtiPluginAudioProcessorEditor() {
-  stopTimer();
 }
 
 //==============================================================================
@@ -92,6 +92,7 @@ void Toolkit3dtiPluginAudioProcessorEditor::resized() {
   anechoicControls.setBounds(10, 54, (area.getWidth()/3)-20, 252);
   reverbControls.setBounds(10, anechoicControls.getBottom(), anechoicControls.getWidth(), 184);
   sourceControls.setBounds(10, reverbControls.getBottom()-1, anechoicControls.getWidth(), 310);
-  spatializerWidget.setBounds(anechoicControls.getRight() + 10, 99, area.getWidth() - anechoicControls.getRight() - 20, area.getHeight() - 110);
+  spatializerWidget.setBounds(anechoicControls.getRight() + 10, 99, area.getWidth() - anechoicControls.getRight() - 20, area.getHeight() - 126);
+  outputMeter.setBounds(spatializerWidget.getX() + 2, spatializerWidget.getBottom() + 4, spatializerWidget.getWidth() - 4, 10);
   aboutText.setBounds(spatializerWidget.getBoundsInParent());
 }
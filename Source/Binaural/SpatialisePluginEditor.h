@@ -26,13 +26,15 @@
 #include "SourceControls.h"
 #include "SpatializerWidget.h"
 #include "ElevationDial.h"
+#include "Common/LevelMeter.h"
+#include "Common/RefreshScheduler.h"
 
 class Toolkit3dtiPluginAudioProcessor;
 
 //==============================================================================
 /**
 */
-class Toolkit3dtiPluginAudioProcessorEditor : public AudioProcessorEditor, public Timer {
+class Toolkit3dtiPluginAudioProcessorEditor : public AudioProcessorEditor {
 public:
   Toolkit3dtiPluginAudioProcessorEditor (Toolkit3dtiPluginAudioProcessor&);
   ~Toolkit3dtiPluginAudioProcessorEditor();
@@ -41,11 +43,12 @@ public:
   void paint (Graphics&) override;
   void resized() override;
   
-  void timerCallback() override {
+  void updateGui() {
     anechoicControls.updateGui();
     reverbControls.updateGui();
     sourceControls.updateGui();
     spatializerWidget.updateGui();
+    outputMeter.updateGui();
     
     bool anechoicEnabled = anechoicControls.bypassToggle.getToggleState();
     anechoicControls.setAlpha(anechoicEnabled + 0.4f);
@@ -69,6 +72,7 @@ private:
   ReverbControls reverbControls;
   AnechoicControls anechoicControls;
   SpatializerWidget spatializerWidget;
+  LevelMeterComponent outputMeter;
   TextEditor aboutText;
   TextButton aboutButton;
   Label pluginVersionLabel;
@@ -78,5 +82,7 @@ private:
   Image imperialLogo;
   Image umaLogo;
 
+  RefreshScheduler refreshScheduler;
+
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Toolkit3dtiPluginAudioProcessorEditor)
 };
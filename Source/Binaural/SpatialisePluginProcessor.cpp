@@ -18,11 +18,15 @@
 * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
 */
 
+#include "Common/PluginState.h"
 #include "SpatialisePluginProcessor.h"
 #include "SpatialisePluginEditor.h"
 
 static constexpr int kTOOLKIT_BUFFER_SIZE = 512; // TODO(Ragnar): Make variable
 
+// Each input channel is rendered as a virtual source, up to a 7.1 bed
+static constexpr int kMAX_INPUT_CHANNELS = 8;
+
 void addBooleanHostParameter(AudioProcessorValueTreeState& treeState, String name, int value)
 {
   const auto bypassValueToText = [](float value) {
@@ -56,64 +60,70 @@ Toolkit3dtiPluginAudioProcessor::Toolkit3dtiPluginAudioProcessor()
       inFifo (2, 512),
       outFifo(2, 512)
 {
+  // Parameter listeners and state restoration expect a source to exist before prepareToPlay
+  mSpatialiser.addSoundSource (Common::CVector3 (0,1,0));
+    
   auto position = mSpatialiser.getSourcePosition();
   
   using Parameter = AudioProcessorValueTreeState::Parameter;
   treeState.createAndAddParameter (std::make_unique<Parameter> ("Azimuth", "Azimuth", "", NormalisableRange<float> (-180.f, 180.f), position.GetAzimuthDegrees(), [](float value) { return String (value, 1); }, nullptr));
-  treeState.addParameterListener ("Azimuth", this);
   
   treeState.createAndAddParameter (std::make_unique<Parameter> ("Elevation", "Elevation", "", NormalisableRange<float>(-89.f, 89.f), position.GetElevationDegrees(), [](float value) { return String (value, 0); }, nullptr));
-  treeState.addParameterListener ("Elevation", this);
 
   treeState.createAndAddParameter (std::make_unique<Parameter> ("Distance", "Distance", "", NormalisableRange<float>(0.001f, 40.f), position.GetDistance(), [](float value) { return String (value, 2); }, nullptr));
-  treeState.addParameterListener ("Distance", this);
   
   treeState.createAndAddParameter (std::make_unique<Parameter> ("X", "X", "", NormalisableRange<float>(-40.f, 40.f), position.x, [](float value) { return String (value, 2); }, nullptr));
-  treeState.addParameterListener ("X", this);
   
   treeState.createAndAddParameter (std::make_unique<Parameter> ("Y", "Y", "", NormalisableRange<float>(-40.f, 40.f), position.y, [](float value) { return String (value, 2); }, nullptr));
-  treeState.addParameterListener ("Y", this);
   
   treeState.createAndAddParameter (std::make_unique<Parameter> ("Z", "Z", "", NormalisableRange<float>(-40.f, 40.f), position.z, [](float value) { return String (value, 2); }, nullptr));
-  treeState.addParameterListener ("Z", this);
   
   treeState.createAndAddParameter (std::make_unique<Parameter> ("Source Attenuation", "Src Attenuation", "", getCore().sourceDistanceAttenuation.range, getCore().sourceDistanceAttenuation.get(), nullptr, nullptr));
-  treeState.addParameterListener ("Source Attenuation", this);
 
   treeState.createAndAddParameter (std::make_unique<Parameter> ("Reverb Level", "Reverb Level", "", getReverbProcessor().reverbLevel.range, getReverbProcessor().reverbLevel.get(), nullptr, nullptr));
-  treeState.addParameterListener ("Reverb Level", this);
 
   addBooleanHostParameter (treeState, "Enable Rev Dist Attenuation", getCore().enableReverbDistanceAttenuation.get());
-  treeState.addParameterListener ("Enable Rev Dist Attenuation", this);
 
   treeState.createAndAddParameter (std::make_unique<Parameter> ("Reverb Attenuation", "Rev Attenuation", "", getCore().reverbDistanceAttenuation.range, getCore().reverbDistanceAttenuation.get(), nullptr, nullptr));
-  treeState.addParameterListener ("Reverb Attenuation", this);
 
   addBooleanHostParameter(treeState, "Near Field", getCore().enableNearDistanceEffect);
-  treeState.addParameterListener ("Near Field", this);
 
   addBooleanHostParameter(treeState, "Far Field", getCore().enableFarDistanceEffect);
-  treeState.addParameterListener ("Far Field", this);
 
   addBooleanHostParameter(treeState, "Custom Head", getCore().enableCustomizedITD);
-  treeState.addParameterListener ("Custom Head", this);
 
   treeState.createAndAddParameter (std::make_unique<Parameter> ("Head Circumference", "Head Circumference", "", NormalisableRange<float>(getCore().headCircumference.getRange().getStart(), getCore().headCircumference.getRange().getEnd()), getCore().headCircumference.get(), [](float value) { return String (value, 0); }, nullptr));
-  treeState.addParameterListener ("Head Circumference", this);
   
   addBooleanHostParameter (treeState, "Enable Anechoic", true);
-  treeState.addParameterListener ("Enable Anechoic", this);
   
   addBooleanHostParameter (treeState, "Enable Reverb", true);
-  treeState.addParameterListener ("Enable Reverb", this);
   
   treeState.createAndAddParameter (std::make_unique<Parameter> ("HRTF", "HRTF", "", NormalisableRange<float>(0, BundledHRTFs.size()), 0, [](float value) { return String (value, 0); }, nullptr));
   treeState.addParameterListener ("HRTF", &mSpatialiser);
   
   treeState.createAndAddParameter (std::make_unique<Parameter> ("BRIR", "BRIR", "", NormalisableRange<float>(0, getReverbProcessor().reverbBRIR.getRange().getEnd() - 1), 0, [](float value) { return String (value, 0); }, nullptr));
-  treeState.addParameterListener ("BRIR", this);
+  
+  treeState.createAndAddParameter (std::make_unique<Parameter> ("Head Yaw", "Head Yaw", "", getCore().listenerYaw.range, getCore().listenerYaw.get(), [](float value) { return String (value, 1); }, nullptr));
+  
+  treeState.createAndAddParameter (std::make_unique<Parameter> ("Head Pitch", "Head Pitch", "", getCore().listenerPitch.range, getCore().listenerPitch.get(), [](float value) { return String (value, 1); }, nullptr));
+  
+  treeState.createAndAddParameter (std::make_unique<Parameter> ("Head Roll", "Head Roll", "", getCore().listenerRoll.range, getCore().listenerRoll.get(), [](float value) { return String (value, 1); }, nullptr));
+  
+  addBooleanHostParameter (treeState, "Head Tracking", getCore().enableHeadTracking.get());
+  
+  treeState.createAndAddParameter (std::make_unique<Parameter> ("Stereo Spread", "Stereo Spread", "", getCore().stereoSpread.range, getCore().stereoSpread.get(), [](float value) { return String (value, 0); }, nullptr));
+  
+  // Changes are dispatched by parameter index, which is the creation order
+  jassert (getParameters().size() == kNumParameters);
+  jassert (treeState.getParameter ("BRIR")->getParameterIndex() == kBRIR);
+  jassert (treeState.getParameter ("Head Tracking")->getParameterIndex() == kHeadTracking);
+  
+  for (auto* parameter : getParameters())
+    parameter->addListener (this);
 
   treeState.state = ValueTree ("3DTI Spatialisation Parameters");
+  
+  setUpHostSync();
     
 #if DEBUG
   ERRORHANDLER3DTI.SetVerbosityMode (VERBOSITYMODE_ERRORSANDWARNINGS);
@@ -190,24 +200,42 @@ void Toolkit3dtiPluginAudioProcessor::changeProgramName (int index, const String
 //==============================================================================
 void Toolkit3dtiPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock) {
   const int blockSizeInternal = kTOOLKIT_BUFFER_SIZE;
+  
+  // Resources only exist for some sample rates, sessions running
+  // at a multiple of one of those are processed at that rate
+  const double processingSampleRate = IntegerResampler::getProcessingSampleRate (sampleRate);
+  const int factor = roundToInt (sampleRate / processingSampleRate);
+  
+  const int numInputs = jmax (1, getTotalNumInputChannels());
+  
+  downsampler.prepare (numInputs, factor);
+  upsampler.prepare (2, factor);
+  
+  downsampled.setSize (numInputs, samplesPerBlock);
+  blockIn.setSize (numInputs, blockSizeInternal);
+  reverbBuffer.setSize (2, blockSizeInternal);
+  upsampled.setSize (2, blockSizeInternal * factor);
     
   inFifo.clear();
-  inFifo.setSize (1, blockSizeInternal + 1);
+  inFifo.setSize (numInputs, blockSizeInternal + 1);
   
   outFifo.clear();
-  outFifo.setSize (2, std::max (samplesPerBlock, blockSizeInternal) * 2);
+  outFifo.setSize (2, std::max (samplesPerBlock, blockSizeInternal * factor) * 2);
    
   scratchBuffer.setSize (2, blockSizeInternal);
+  
+  setLatencySamples (downsampler.getLatencySamples() + upsampler.getLatencySamples());
     
   Common::TAudioStateStruct audioState;
   audioState.bufferSize = blockSizeInternal;
-  audioState.sampleRate = sampleRate;
+  audioState.sampleRate = processingSampleRate;
   mCore.SetAudioState (audioState);
     
-  mSpatialiser.setup (sampleRate);
-  mReverb.setup (sampleRate, blockSizeInternal);
+  mSpatialiser.setInputLayout (getChannelLayoutOfBus (true, 0));
+  mSpatialiser.setup (processingSampleRate);
+  mReverb.setup (processingSampleRate, blockSizeInternal);
   
-  startTimer(60);
+  mOutputMeter.prepare (sampleRate, 2);
 }
 
 void Toolkit3dtiPluginAudioProcessor::releaseResources() {
@@ -218,8 +246,13 @@ void Toolkit3dtiPluginAudioProcessor::releaseResources() {
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool Toolkit3dtiPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    if (layouts.getMainInputChannelSet() != AudioChannelSet::mono()
-     && layouts.getMainInputChannelSet() != AudioChannelSet::stereo())
+    auto input = layouts.getMainInputChannelSet();
+    
+    if (input.isDisabled() || input.size() > kMAX_INPUT_CHANNELS)
+        return false;
+    
+    // Every channel needs a place around the listener
+    if (! AnechoicProcessor::isInputLayoutSupported (input))
         return false;
     
     if (layouts.getMainOutputChannelSet() != AudioChannelSet::stereo())
@@ -239,47 +272,53 @@ void Toolkit3dtiPluginAudioProcessor::processBlock (AudioBuffer<float>& buffer,
   for (auto i = inChannels; i < outChannels; ++i)
     buffer.clear(i, 0, buffer.getNumSamples());
   
-  int numSamples  = buffer.getNumSamples();
-  int numChannels = buffer.getNumChannels();
+  int numSamples = buffer.getNumSamples();
+  int numInputs  = downsampled.getNumChannels();
 
-  AudioBuffer<float> temp (1, 1);
+  // Only reallocates if the host exceeds the block size it announced
+  downsampled.setSize (numInputs, numSamples, false, false, true);
+  
+  // Channels stay separate, each one feeds its own virtual source
+  int numDownsampled = downsampler.downsample (buffer, numSamples, downsampled);
+  
   // Some hosts send buffers of varying sizes so we maintain
   // an internal buffer to pass the correct size to the 3dti core
-  for (int sample = 0; sample < numSamples; ++sample)
+  for (int position = 0; position < numDownsampled;)
   {
-    temp.clear();
-      
-    // Sum to mono in 'temp'
-    for (int channel = 0; channel < numChannels; ++channel)
-        temp.addSample (0, 0, buffer.getSample (channel, sample));
+    int numToAdd = std::min (inFifo.getFreeSpace(), numDownsampled - position);
     
-    temp.applyGain (1.0f / (float)numChannels);
-      
-    inFifo.addToFifo (temp);
+    const float* samples[kMAX_INPUT_CHANNELS];
+    
+    for (int channel = 0; channel < numInputs; ++channel)
+      samples[channel] = downsampled.getReadPointer (channel, position);
+    
+    inFifo.addToFifo (samples, numToAdd);
+    
+    position += numToAdd;
 
     if (inFifo.getFreeSpace() == 0)
     {
       const int blockSizeInternal = kTOOLKIT_BUFFER_SIZE;
         
-      AudioBuffer<float> monoIn (1, blockSizeInternal);
-      inFifo.readFromFifo (monoIn, blockSizeInternal);
+      inFifo.readFromFifo (blockIn, blockSizeInternal);
 
       // Main process
-      mSpatialiser.processBlock (monoIn, scratchBuffer);
+      mSpatialiser.processBlock (blockIn, scratchBuffer);
 
       bool reverbEnabled = getSources().front()->IsReverbProcessEnabled();
       
       if (reverbEnabled)
       {
-        AudioBuffer<float> reverbBuffer (scratchBuffer);
+        reverbBuffer.makeCopyOf (scratchBuffer, true);
         
         mReverb.process (reverbBuffer);
 
-        for (int ch = 0; ch < numChannels; ch++)
+        for (int ch = 0; ch < scratchBuffer.getNumChannels(); ch++)
           scratchBuffer.addFrom (ch, 0, reverbBuffer, ch, 0, blockSizeInternal);
       }
 
-      outFifo.addToFifo(scratchBuffer);
+      upsampler.upsample (scratchBuffer, blockSizeInternal, upsampled);
+      outFifo.addToFifo(upsampled);
     }
   }
     
@@ -295,6 +334,7 @@ void Toolkit3dtiPluginAudioProcessor::processBlock (AudioBuffer<float>& buffer,
   }
 
   outFifo.readFromFifo(buffer);
+  mOutputMeter.process (buffer, numSamples);
 }
 
 //==============================================================================
@@ -311,119 +351,196 @@ AudioProcessorEditor* Toolkit3dtiPluginAudioProcessor::createEditor()
 //==============================================================================
 void Toolkit3dtiPluginAudioProcessor::getStateInformation (MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    auto state = treeState.copyState();
+    
+    auto position = getCore().getSourcePosition();
+    
+    auto source = state.getOrCreateChildWithName ("Source", nullptr);
+    source.setProperty ("X", position.x, nullptr);
+    source.setProperty ("Y", position.y, nullptr);
+    source.setProperty ("Z", position.z, nullptr);
+    
+    state.setProperty ("HRTFPath", getCore().getHrtfPath().getFullPathName(), nullptr);
+    state.setProperty ("BRIRPath", getReverbProcessor().getBRIRPath().getFullPathName(), nullptr);
+    state.setProperty ("SpatializationMode", getCore().spatializationMode.get(), nullptr);
+    state.setProperty ("ReverbOrder", getReverbProcessor().reverbOrder.get(), nullptr);
+    
+    PluginState::write (state, destData);
 }
 
 void Toolkit3dtiPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    auto state = PluginState::read (data, sizeInBytes);
+    
+    if (! state.hasType (treeState.state.getType()))
+        return;
+    
+    // Apply the whole state before the next block is processed
+    suspendProcessing (true);
+    
+    // The HRTF and BRIR parameters would trigger loads of their own, so
+    // the selected files are restored explicitly and loaded only once
+    treeState.removeParameterListener ("HRTF", &mSpatialiser);
+    getParameters()[kBRIR]->removeListener (this);
+    treeState.replaceState (state);
+    treeState.addParameterListener ("HRTF", &mSpatialiser);
+    getParameters()[kBRIR]->addListener (this);
+    
+    getCore().spatializationMode = (int)state.getProperty ("SpatializationMode", getCore().spatializationMode.get());
+    getReverbProcessor().reverbOrder = (int)state.getProperty ("ReverbOrder", getReverbProcessor().reverbOrder.get());
+    
+    auto source = state.getChildWithName ("Source");
+    
+    if (source.isValid() && ! getSources().empty())
+    {
+        Common::CVector3 position ((float)source["X"], (float)source["Y"], (float)source["Z"]);
+        getCore().setSourcePosition (position);
+    }
+    
+    getCore().restoreHRTF (File (state["HRTFPath"].toString()));
+    getReverbProcessor().restoreBRIR (File (state["BRIRPath"].toString()));
+    
+    // The restored file may differ from the saved one, e.g. if it was missing
+    if (getCore().getHrtfPath() != File())
+    {
+        auto* hrtf = treeState.getParameter ("HRTF");
+        
+        treeState.removeParameterListener ("HRTF", &mSpatialiser);
+        hrtf->setValueNotifyingHost (hrtf->convertTo0to1 ((float)hrtfPathToBundledIndex (getCore().getHrtfPath())));
+        treeState.addParameterListener ("HRTF", &mSpatialiser);
+    }
+    
+    suspendProcessing (false);
 }
 
-void Toolkit3dtiPluginAudioProcessor::updateHostParameters() {
-  auto position = getCore().getSourcePosition();
+void Toolkit3dtiPluginAudioProcessor::setUpHostSync() {
+  auto& core = getCore();
   
-  std::unordered_map<String, float> parameters = {
-    {"Azimuth", AzimuthMapper::fromToolkit (position.GetAzimuthDegrees())},
-    {"Distance", position.GetDistance()},
-    {"Elevation", mapElevationToSliderValue(position.GetElevationDegrees())},
-    {"X", position.x},
-    {"Y", position.y},
-    {"Z", position.z},
-    {"Source Attenuation", getCore().sourceDistanceAttenuation},
-    {"Reverb Gain", getReverbProcessor().reverbLevel},
-    {"Enable Rev Dist Attenuation", getCore().enableReverbDistanceAttenuation},
-    {"Reverb Attenuation", getCore().reverbDistanceAttenuation},
-    {"Near Field", getCore().enableNearDistanceEffect},
-    {"Far Field", getCore().enableFarDistanceEffect},
-    {"Custom Head", getCore().enableCustomizedITD},
-    {"Head Circumference", getCore().headCircumference},
-    {"Enable Anechoic", getCore().getSources().front()->IsAnechoicProcessEnabled()},
-    {"Enable Reverb", getCore().getSources().front()->IsReverbProcessEnabled()},
-    {"BRIR", getReverbProcessor().reverbBRIR.get()},
-  };
+  uint32 sourceFlags = 0;
+  sourceFlags |= hostSync.add ("Azimuth",   [&core] { return AzimuthMapper::fromToolkit (core.getSourcePosition().GetAzimuthDegrees()); });
+  sourceFlags |= hostSync.add ("Distance",  [&core] { return core.getSourcePosition().GetDistance(); });
+  sourceFlags |= hostSync.add ("Elevation", [&core] { return mapElevationToSliderValue (core.getSourcePosition().GetElevationDegrees()); });
+  sourceFlags |= hostSync.add ("X", [&core] { return core.getSourcePosition().x; });
+  sourceFlags |= hostSync.add ("Y", [&core] { return core.getSourcePosition().y; });
+  sourceFlags |= hostSync.add ("Z", [&core] { return core.getSourcePosition().z; });
+  sourceFlags |= hostSync.add ("Enable Anechoic", [&core] { return (float)core.getSources().front()->IsAnechoicProcessEnabled(); });
+  sourceFlags |= hostSync.add ("Enable Reverb",   [&core] { return (float)core.getSources().front()->IsReverbProcessEnabled(); });
+  
+  core.onSourceChanged = [this, sourceFlags] { hostSync.markDirty (sourceFlags); };
+  
+  hostSync.add ("Source Attenuation",          core.sourceDistanceAttenuation);
+  hostSync.add ("Reverb Level",                getReverbProcessor().reverbLevel);
+  hostSync.add ("Enable Rev Dist Attenuation", core.enableReverbDistanceAttenuation);
+  hostSync.add ("Reverb Attenuation",          core.reverbDistanceAttenuation);
+  hostSync.add ("Near Field",                  core.enableNearDistanceEffect);
+  hostSync.add ("Far Field",                   core.enableFarDistanceEffect);
+  hostSync.add ("Custom Head",                 core.enableCustomizedITD);
+  hostSync.add ("Head Circumference",          core.headCircumference);
+  hostSync.add ("Head Yaw",                    core.listenerYaw);
+  hostSync.add ("Head Pitch",                  core.listenerPitch);
+  hostSync.add ("Head Roll",                   core.listenerRoll);
+  hostSync.add ("Head Tracking",               core.enableHeadTracking);
+  hostSync.add ("Stereo Spread",               core.stereoSpread);
+  hostSync.add ("BRIR",                        getReverbProcessor().reverbBRIR);
+}
 
-  for (auto const & parameter : parameters)
-  {
-    if (auto* p = treeState.getParameter(parameter.first) )
-    {
-        auto range = treeState.getParameterRange (parameter.first);
-        
-        if (parameter.second < range.start || parameter.second > range.end)
-            continue;
-        
-        auto newValue = range.convertTo0to1 (parameter.second);
-      
-        if (fabsf (p->getValue() - newValue) > std::numeric_limits<float>::epsilon())
-        {
-            treeState.removeParameterListener (parameter.first, this);
-            p->setValueNotifyingHost(newValue);
-            treeState.addParameterListener (parameter.first, this);
-        }
-    }
-  }
+void Toolkit3dtiPluginAudioProcessor::parameterValueChanged (int parameterIndex, float newValue) {
+  auto* parameter = static_cast<RangedAudioParameter*> (getParameters().getUnchecked (parameterIndex));
+  parameterChanged ((ParameterIndex)parameterIndex, parameter->convertFrom0to1 (newValue));
 }
 
-void Toolkit3dtiPluginAudioProcessor::parameterChanged(const String& parameterID, float newValue) {
+void Toolkit3dtiPluginAudioProcessor::parameterChanged (ParameterIndex parameter, float newValue) {
+  auto const& sources = getCore().getSources();
+  
+  if (sources.empty())
+    return;
+  
   auto position = getCore().getSourcePosition();
   
-  if ( parameterID == "Azimuth" )
+  switch (parameter)
   {
-    auto azimuth = AzimuthMapper::toToolkit (newValue);
-    position.SetFromAED (azimuth, position.GetElevationDegrees(), position.GetDistance());
-  } else if ( parameterID == "Distance" ) {
-    position.SetFromAED( position.GetAzimuthDegrees(), position.GetElevationDegrees(), newValue );
-  } else if ( parameterID == "Elevation" ) {
-    position.SetFromAED( position.GetAzimuthDegrees(), mapSliderValueToElevation(newValue), position.GetDistance() );
-  } else if ( parameterID == "X" ) {
-    position.x = newValue;
-  } else if ( parameterID == "Y" ) {
-    position.y = newValue;
-  } else if ( parameterID == "Z" ) {
-    position.z = newValue;
-  } else if ( parameterID == "Source Attenuation" ) {
-    getCore().sourceDistanceAttenuation = newValue;
-  } else if ( parameterID == "Reverb Level" ) {
-    getReverbProcessor().reverbLevel = newValue;
-  } else if ( parameterID == "Enable Rev Dist Attenuation" ) {
-    getCore().enableReverbDistanceAttenuation = (bool)newValue;
-  } else if ( parameterID == "Reverb Attenuation" ) {
-    getCore().reverbDistanceAttenuation = newValue;
-  } else if ( parameterID == "Near Field" ) {
-    getCore().enableNearDistanceEffect = (int)(newValue + 0.49f);
-  } else if ( parameterID == "Far Field" ) {
-    getCore().enableFarDistanceEffect = (int)(newValue + 0.49f);
-  } else if ( parameterID == "Custom Head" ) {
-    getCore().enableCustomizedITD = (int)(newValue + 0.49f);
-  } else if ( parameterID == "Head Circumference" ) {
-    if ( getCore().enableCustomizedITD ){
-      getCore().headCircumference = newValue;
-    }
-  } else if ( parameterID == "Enable Anechoic" ) {
-    if ( auto source = getCore().getSources().front() ) {
-      bool enabled = (bool)newValue;
-      if ( enabled ) {
-        source->EnableAnechoicProcess();
+    case kAzimuth:
+      position.SetFromAED (AzimuthMapper::toToolkit (newValue), position.GetElevationDegrees(), position.GetDistance());
+      break;
+    case kDistance:
+      position.SetFromAED( position.GetAzimuthDegrees(), position.GetElevationDegrees(), newValue );
+      break;
+    case kElevation:
+      position.SetFromAED( position.GetAzimuthDegrees(), mapSliderValueToElevation(newValue), position.GetDistance() );
+      break;
+    case kX:
+      position.x = newValue;
+      break;
+    case kY:
+      position.y = newValue;
+      break;
+    case kZ:
+      position.z = newValue;
+      break;
+    case kSourceAttenuation:
+      getCore().sourceDistanceAttenuation = newValue;
+      return;
+    case kReverbLevel:
+      getReverbProcessor().reverbLevel = newValue;
+      return;
+    case kEnableRevDistAttenuation:
+      getCore().enableReverbDistanceAttenuation = (bool)newValue;
+      return;
+    case kReverbAttenuation:
+      getCore().reverbDistanceAttenuation = newValue;
+      return;
+    case kNearField:
+      getCore().enableNearDistanceEffect = (int)(newValue + 0.49f);
+      return;
+    case kFarField:
+      getCore().enableFarDistanceEffect = (int)(newValue + 0.49f);
+      return;
+    case kCustomHead:
+      getCore().enableCustomizedITD = (int)(newValue + 0.49f);
+      return;
+    case kHeadCircumference:
+      if ( getCore().enableCustomizedITD ){
+        getCore().headCircumference = newValue;
+      }
+      return;
+    case kHeadYaw:
+      getCore().listenerYaw = newValue;
+      return;
+    case kHeadPitch:
+      getCore().listenerPitch = newValue;
+      return;
+    case kHeadRoll:
+      getCore().listenerRoll = newValue;
+      return;
+    case kHeadTracking:
+      getCore().enableHeadTracking = newValue > 0.5f;
+      return;
+    case kStereoSpread:
+      getCore().stereoSpread = newValue;
+      return;
+    case kEnableAnechoic:
+      if ( (bool)newValue ) {
+        sources.front()->EnableAnechoicProcess();
       } else {
-        source->DisableAnechoicProcess();
+        sources.front()->DisableAnechoicProcess();
       }
-    }
-  } else if ( parameterID == "Enable Reverb" ) {
-    if ( auto source = getCore().getSources().front() ) {
-      bool enabled = (bool)newValue;
-      if ( enabled ) {
-        getCore().getSources().front()->EnableReverbProcess();
+      return;
+    case kEnableReverb:
+      if ( (bool)newValue ) {
+        sources.front()->EnableReverbProcess();
       } else {
-        getCore().getSources().front()->DisableReverbProcess();
+        sources.front()->DisableReverbProcess();
       }
-    }
-  } else if ( parameterID == "BRIR" ) {
+      return;
+    case kBRIR:
       getReverbProcessor().reverbBRIR = roundToInt (newValue);
+      return;
+    default:
+      // The HRTF is handled by the AnechoicProcessor
+      return;
   }
 
-  getCore().setSourcePosition(getCore().getSources().front(), position);
+  getCore().setSourcePosition (position);
 }
 
 //==============================================================================
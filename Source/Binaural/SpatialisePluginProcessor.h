@@ -24,14 +24,15 @@
 #include <ff_buffers/ff_buffers_AudioBufferFIFO.h>
 #include "AnechoicProcessor.h"
 #include "ReverbProcessor.h"
+#include "IntegerResampler.h"
+#include "HostParameterSync.h"
 
 //==============================================================================
 /**
 */
 
 class Toolkit3dtiPluginAudioProcessor : public  AudioProcessor,
-                                        private AudioProcessorValueTreeState::Listener,
-                                        private Timer
+                                        private AudioProcessorParameter::Listener
 {
 public:
   //============================================================================
@@ -74,6 +75,9 @@ public:
   //============================================================================
   AnechoicProcessor& getCore()            { return mSpatialiser; }
   ReverbProcessor&   getReverbProcessor() { return mReverb; }
+  
+  /** Measures the output, at the host sample rate */
+  LevelMeter&        getOutputMeter()     { return mOutputMeter; }
     
   const std::vector<CSingleSourceRef>& getSources() {
       return getCore().getSources();
@@ -83,19 +87,56 @@ public:
   
 private:
   
-  void timerCallback() override { updateHostParameters(); }
+  /** Host parameters, in the order they are created */
+  enum ParameterIndex
+  {
+    kAzimuth,
+    kElevation,
+    kDistance,
+    kX,
+    kY,
+    kZ,
+    kSourceAttenuation,
+    kReverbLevel,
+    kEnableRevDistAttenuation,
+    kReverbAttenuation,
+    kNearField,
+    kFarField,
+    kCustomHead,
+    kHeadCircumference,
+    kEnableAnechoic,
+    kEnableReverb,
+    kHRTF,
+    kBRIR,
+    kHeadYaw,
+    kHeadPitch,
+    kHeadRoll,
+    kHeadTracking,
+    kStereoSpread,
+    kNumParameters
+  };
+  
+  void setUpHostSync();
   
-  void updateHostParameters();
+  /** AudioProcessorParameter::Listener */
+  void parameterValueChanged (int parameterIndex, float newValue) override;
+  void parameterGestureChanged (int, bool) override {}
   
-  void parameterChanged(const String& parameterID, float newValue) override;
+  void parameterChanged (ParameterIndex parameter, float newValue);
     
-  AudioBuffer<float>     scratchBuffer;
+  AudioBuffer<float>     scratchBuffer, reverbBuffer;
+  AudioBuffer<float>     downsampled, blockIn, upsampled;
+  IntegerResampler       downsampler, upsampler;
   AudioBufferFIFO<float> inFifo, outFifo;
     
   Binaural::CCore mCore;
   AnechoicProcessor mSpatialiser {mCore};
   ReverbProcessor mReverb {mCore};
   
+  HostParameterSync hostSync {treeState, *this};
+  
+  LevelMeter mOutputMeter;
+  
   //==============================================================================
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Toolkit3dtiPluginAudioProcessor)
 };
@@ -31,6 +31,10 @@
 static const float RANGE_METERS = 40.f;
 static const int kMargins = 20;
 
+// Above this many sources only the selected one shows its coordinates,
+// and any movement repaints the whole widget instead of each glyph
+static const int kMaxLabelledSources = 8;
+
 class SpatializerWidget : public Component, public Slider::Listener {
 public:
   SpatializerWidget(AnechoicProcessor& core) : mCore(core) {
@@ -48,95 +52,63 @@ public:
   ~SpatializerWidget() {}
   
   void paint (Graphics& g) override {
-    g.fillAll(getLookAndFeel().findColour(ResizableWindow::backgroundColourId));  // clear the background
+    // The rings and axes only change with the size, the head radius or the display scale
+    auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
     
-    g.setColour(Colours::grey);
+    if ( background.isNull() || backgroundScale != scale || backgroundHeadRadius != mCore.getHeadRadius() )
+      renderBackground (scale);
     
-    auto localBounds = getLocalBounds().reduced (kMargins);
-    auto centrePoint = localBounds.getCentre().toFloat();
+    g.drawImageTransformed (background, AffineTransform::scale (1.f / backgroundScale));
     
-    // Draw listener head and distance radii
-    // Note(Ragnar): Add a scale factor pixels > meters
-    for ( auto radius : { mCore.getHeadRadius(), 1.5f, 7.f, 20.f, RANGE_METERS } ) {
-      auto x = scaledRange.convertFrom0to1(radius / RANGE_METERS) * 2.f; // * 2 for diameter
-      
-      auto rect = Rectangle<float>(0,0, x, x).withCentre(centrePoint);
-      
-      String distance;
-      
-      if ( radius < 1.f ) {
-        g.setColour(Colours::slategrey);
-        g.fillEllipse(rect);
-        distance = String(radius, 2) + "m";
-      } else {
-        g.setColour(Colours::grey);
-        g.drawEllipse(rect, 1);
-        distance = String(radius, 0) + "m";
-      }
-      
-      g.setColour(Colours::ghostwhite);
-      
-      if ( radius == RANGE_METERS )
-        continue;
-      
-      g.drawFittedText(distance,
-                       rect.toNearestIntEdges().withTrimmedLeft(4).withTrimmedBottom(16),
-                       Justification::left,
-                       1);
-    }
-    
-    // Draw axes
-    for ( auto radius : { 20.f } ) {
-      auto x = scaledRange.convertFrom0to1(radius / RANGE_METERS) * 2.f; // * 2 for diameter
-      
-      auto rect = Rectangle<float>(0,0, x, x).withCentre(centrePoint);
+    // Draw all sources as a single path
+    Path sources;
     
-      g.drawLine(rect.getX(), rect.getCentreY(), rect.getRight(), rect.getCentreY());
-      g.drawLine(rect.getCentreX(), rect.getY(), rect.getCentreX(), rect.getBottom());
-      
-      rect = rect.withSizeKeepingCentre(x*0.707f, x*0.707f);
-      g.setColour(Colours::grey);
-      g.drawLine(rect.getX(), rect.getY(), rect.getRight(), rect.getBottom());
-      g.drawLine(rect.getX(), rect.getBottom(), rect.getRight(), rect.getY());
-    }
+    for ( auto const& sourceRect : sourceRects )
+      sources.addEllipse (sourceRect);
     
-    auto position = mCore.getSourcePosition(0);
-    
-    auto drawPosition = position;
-    drawPosition.SetFromAED(position.GetAzimuthDegrees(), 0, position.GetDistance());
-    auto distance = scaledRange.convertFrom0to1(position.GetDistance() / RANGE_METERS);
-    auto angle = 360.f - drawPosition.GetAzimuthDegrees();
-    auto point = Point<float>().getPointOnCircumference(distance, degreesToRadians(angle));
-    
-    // Draw source
     g.setColour (Colours::blueviolet.brighter());
-    auto sourceRect = Rectangle<float>(0,0,20,20);
-    sourceRect.setCentre(point + centrePoint);
-    g.fillEllipse(sourceRect);
+    g.fillPath (sources);
   
     // Draw source coordinate info
     g.setColour (Colours::white);
     g.setFont(15.0f);
-    Rectangle<int> positionRect(100, 20);
-    positionRect.setCentre( sourceRect.getCentre().x, sourceRect.getCentre().y - 12 );
-    g.drawFittedText("x: "  + String(position.x > 0.f ? "  " : "") + String(position.x, 2)
-                  + "\ny: " + String(position.y > 0.f ? "  " : "") + String(position.y, 2)
-                  + "\nz: " + String(position.z > 0.f ? "  " : "") + String(position.z, 2),
-                     positionRect.withX(positionRect.getX() - 26),
-                     Justification::left,
-                     1);
-
-    // Position elevation dial
-    elevationDial.setCentrePosition(sourceRect.getCentre().toInt() + Point<int>(30,0));
+    
+    for ( int i = 0; i < positions.size(); ++i ) {
+      if ( ! isLabelled (i) )
+        continue;
+      
+      auto const& position = positions.getReference (i);
+      g.drawFittedText("x: "  + String(position.x > 0.f ? "  " : "") + String(position.x, 2)
+                    + "\ny: " + String(position.y > 0.f ? "  " : "") + String(position.y, 2)
+                    + "\nz: " + String(position.z > 0.f ? "  " : "") + String(position.z, 2),
+                       getPositionTextRect (sourceRects.getReference (i)),
+                       Justification::left,
+                       1);
+    }
   }
   
   void resized() override {
     auto height = getLocalBounds().reduced (kMargins).getHeight();
     scaledRange = NormalisableRange<float>(0, height * 0.5f, 1.f, 3.5f);
+    
+    background = Image();
+    positionsVersion = ~0u;
+    updateGui();
+    repaint();
   }
   
-  void mouseDown(const MouseEvent&) override {
+  void mouseDown(const MouseEvent& event) override {
     mouseIsDown = true;
+    
+    // Pick the source under the mouse, otherwise keep dragging the last one
+    auto index = getSourceAt (event.position);
+    
+    if ( index >= 0 && index != selectedSource ) {
+      selectedSource = index;
+      positionsVersion = ~0u;
+      updateGui();
+      repaint();
+    }
   }
   
   void mouseUp(const MouseEvent&) override {
@@ -160,8 +132,11 @@ public:
     auto value = scaledRange.convertTo0to1(distance) * maxValue;
     auto distanceScaled = jlimit<float>(minValue, maxValue, value);
     
-    auto source = mCore.getSources().front();
-    auto position = mCore.getSourcePosition(source);
+    if ( selectedSource >= (int)mCore.getSources().size() )
+      return;
+    
+    auto source = mCore.getSources()[selectedSource];
+    auto position = mCore.getSourcePosition(selectedSource);
     position.SetFromAED (azimuth, position.GetElevationDegrees(), distanceScaled);
     mCore.setSourcePosition(source, position);
     
@@ -170,12 +145,51 @@ public:
   }
   
   void updateGui() {
+    if ( backgroundHeadRadius != mCore.getHeadRadius() ) {
+      repaint();
+    }
+    
+    // Nothing to do unless a source was added or moved
+    auto version = mCore.getSourcePositionsVersion();
+    
+    if ( version == positionsVersion )
+      return;
+    
+    previousPositions.swapWith (positions);
+    previousRects.swapWith (sourceRects);
+    
+    positionsVersion = mCore.getSourcePositions (positions);
+    
+    if ( positions.isEmpty() )
+      return;
+    
+    selectedSource = jmin (selectedSource, positions.size() - 1);
+    
     if ( !mouseIsDown ) {
-      auto elevation = mCore.getSourcePosition(0).GetElevationDegrees();
+      auto elevation = positions.getReference (selectedSource).GetElevationDegrees();
       elevationDial.setValue(mapElevationToSliderValue(elevation) * -1.f, // Elevation slider range is swapped because
                              dontSendNotification);                       // it plays better with the rotary style
     }
-    repaint();
+    
+    updateSourceRects();
+    
+    // With few sources only the glyphs that changed are redrawn, their old
+    // and new areas. Beyond that a single full repaint is cheaper
+    if ( positions.size() > kMaxLabelledSources || previousRects.size() != sourceRects.size() ) {
+      repaint();
+    } else {
+      for ( int i = 0; i < sourceRects.size(); ++i ) {
+        auto const& position = positions.getReference (i);
+        auto const& previous = previousPositions.getReference (i);
+        
+        if ( position.x != previous.x || position.y != previous.y || position.z != previous.z ) {
+          repaint (getGlyphBounds (previousRects.getReference (i)));
+          repaint (getGlyphBounds (sourceRects.getReference (i)));
+        }
+      }
+    }
+    
+    elevationDial.setCentrePosition(sourceRects.getReference (selectedSource).getCentre().toInt() + Point<int>(30,0));
   }
   
   //==============================================================================
@@ -187,17 +201,185 @@ public:
 private:
   AnechoicProcessor& mCore;
   
+  Point<float> getCentrePoint() const {
+    return getLocalBounds().reduced (kMargins).getCentre().toFloat();
+  }
+  
+  Rectangle<float> getSourceRect (Common::CVector3 position) const {
+    auto drawPosition = position;
+    drawPosition.SetFromAED(position.GetAzimuthDegrees(), 0, position.GetDistance());
+    auto distance = scaledRange.convertFrom0to1(jmin (position.GetDistance(), RANGE_METERS) / RANGE_METERS);
+    auto angle = 360.f - drawPosition.GetAzimuthDegrees();
+    auto point = Point<float>().getPointOnCircumference(distance, degreesToRadians(angle));
+    
+    return Rectangle<float>(0,0,20,20).withCentre(point + getCentrePoint());
+  }
+  
+  bool isLabelled (int index) const {
+    return positions.size() <= kMaxLabelledSources || index == selectedSource;
+  }
+  
+  static Rectangle<int> getGlyphBounds (Rectangle<float> sourceRect) {
+    return getPositionTextRect (sourceRect).getUnion (sourceRect.toNearestIntEdges()).expanded (2);
+  }
+  
+  void updateSourceRects() {
+    sourceRects.clearQuick();
+    
+    auto numColumns = getWidth()  / kGridCellSize + 1;
+    auto numRows    = getHeight() / kGridCellSize + 1;
+    
+    grid.resize ((size_t)(numColumns * numRows));
+    
+    for ( auto& cell : grid )
+      cell.clearQuick();
+    
+    gridColumns = numColumns;
+    
+    for ( int i = 0; i < positions.size(); ++i ) {
+      auto rect = getSourceRect (positions.getReference (i));
+      sourceRects.add (rect);
+      
+      if ( auto* cell = getGridCell (rect.getCentre()) )
+        cell->add (i);
+    }
+  }
+  
+  Array<int>* getGridCell (Point<float> point) {
+    auto column = (int)std::floor (point.x / kGridCellSize);
+    auto row    = (int)std::floor (point.y / kGridCellSize);
+    
+    if ( column < 0 || row < 0 || column >= gridColumns || row * gridColumns + column >= (int)grid.size() )
+      return nullptr;
+    
+    return &grid[(size_t)(row * gridColumns + column)];
+  }
+  
+  /** @returns the index of the source glyph under a point, or -1 if there is none */
+  int getSourceAt (Point<float> point) {
+    int nearest = -1;
+    float nearestDistance = 0.f;
+    
+    // Glyphs are smaller than a cell, so the neighbouring cells hold every candidate
+    for ( int dx = -1; dx <= 1; ++dx ) {
+      for ( int dy = -1; dy <= 1; ++dy ) {
+        auto* cell = getGridCell (point.translated ((float)(dx * kGridCellSize), (float)(dy * kGridCellSize)));
+        
+        if ( cell == nullptr )
+          continue;
+        
+        for ( auto index : *cell ) {
+          auto const& rect = sourceRects.getReference (index);
+          auto distance = rect.getCentre().getDistanceFrom (point);
+          
+          if ( distance <= rect.getWidth() * 0.5f && (nearest < 0 || distance < nearestDistance) ) {
+            nearest = index;
+            nearestDistance = distance;
+          }
+        }
+      }
+    }
+    
+    return nearest;
+  }
+  
+  static Rectangle<int> getPositionTextRect (Rectangle<float> sourceRect) {
+    Rectangle<int> positionRect(100, 20);
+    positionRect.setCentre( sourceRect.getCentre().x, sourceRect.getCentre().y - 12 );
+    return positionRect.withX(positionRect.getX() - 26);
+  }
+  
+  void renderBackground (float scale) {
+    backgroundScale = scale;
+    backgroundHeadRadius = mCore.getHeadRadius();
+    background = Image (Image::RGB, jmax (1, roundToInt (getWidth() * scale)), jmax (1, roundToInt (getHeight() * scale)), false);
+    
+    Graphics g (background);
+    g.addTransform (AffineTransform::scale (scale));
+    
+    g.fillAll(getLookAndFeel().findColour(ResizableWindow::backgroundColourId));  // clear the background
+    
+    g.setColour(Colours::grey);
+    
+    auto centrePoint = getCentrePoint();
+    
+    // Draw listener head and distance radii
+    // Note(Ragnar): Add a scale factor pixels > meters
+    for ( auto radius : { backgroundHeadRadius, 1.5f, 7.f, 20.f, RANGE_METERS } ) {
+      auto x = scaledRange.convertFrom0to1(radius / RANGE_METERS) * 2.f; // * 2 for diameter
+      
+      auto rect = Rectangle<float>(0,0, x, x).withCentre(centrePoint);
+      
+      String distance;
+      
+      if ( radius < 1.f ) {
+        g.setColour(Colours::slategrey);
+        g.fillEllipse(rect);
+        distance = String(radius, 2) + "m";
+      } else {
+        g.setColour(Colours::grey);
+        g.drawEllipse(rect, 1);
+        distance = String(radius, 0) + "m";
+      }
+      
+      g.setColour(Colours::ghostwhite);
+      
+      if ( radius == RANGE_METERS )
+        continue;
+      
+      g.drawFittedText(distance,
+                       rect.toNearestIntEdges().withTrimmedLeft(4).withTrimmedBottom(16),
+                       Justification::left,
+                       1);
+    }
+    
+    // Draw axes
+    for ( auto radius : { 20.f } ) {
+      auto x = scaledRange.convertFrom0to1(radius / RANGE_METERS) * 2.f; // * 2 for diameter
+      
+      auto rect = Rectangle<float>(0,0, x, x).withCentre(centrePoint);
+    
+      g.drawLine(rect.getX(), rect.getCentreY(), rect.getRight(), rect.getCentreY());
+      g.drawLine(rect.getCentreX(), rect.getY(), rect.getCentreX(), rect.getBottom());
+      
+      rect = rect.withSizeKeepingCentre(x*0.707f, x*0.707f);
+      g.setColour(Colours::grey);
+      g.drawLine(rect.getX(), rect.getY(), rect.getRight(), rect.getBottom());
+      g.drawLine(rect.getX(), rect.getBottom(), rect.getRight(), rect.getY());
+    }
+  }
+  
   void applyElevationRotation() {                                              // Elevation slider range is swapped becauses
     auto degrees = mapSliderValueToElevation(elevationDial.getValue()) * -1.f; // it plays better with the rotary style
-    auto position = mCore.getSourcePosition (mCore.getSources().front());
+    if ( selectedSource >= (int)mCore.getSources().size() )
+      return;
+    
+    auto position = mCore.getSourcePosition (selectedSource);
     position.SetFromAED(position.GetAzimuthDegrees(), degrees, position.GetDistance());
     
-    auto source = mCore.getSources().front();
+    auto source = mCore.getSources()[selectedSource];
     mCore.setSourcePosition (source, position);
   }
   
-  bool mouseIsDown;
+  bool mouseIsDown = false;
   ElevationDial elevationDial;
+  
+  // Static rings, labels and axes, rendered at the display scale
+  Image background;
+  float backgroundScale = 1.f;
+  float backgroundHeadRadius = -1.f;
+  
+  // Snapshot of the source positions and where their glyphs are drawn
+  Array<Common::CVector3> positions, previousPositions;
+  Array<Rectangle<float>> sourceRects, previousRects;
+  uint32 positionsVersion = ~0u;
+  int    selectedSource = 0;
+  
+  // Source indices bucketed by screen position, for hit testing
+  static constexpr int kGridCellSize = 32;
+  std::vector<Array<int>> grid;
+  int gridColumns = 0;
+  
   // Used to scale screen coordinates to spatialised position
   NormalisableRange<float> scaledRange;
   
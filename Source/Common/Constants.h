@@ -17,4 +17,19 @@
 namespace Constants
 {
     static constexpr int NUM_BANDS = 9;
+    
+    /** The octave bands of the hearing loss audiometry, as set up in the
+        hearing loss simulator's multiband expanders
+     */
+    struct AudiometryBands
+    {
+        static constexpr int size() { return HL_BANDS_NUMBER; }
+        
+        static constexpr double getFrequency (int band)
+        {
+            return band <= 0 ? HL_INITIAL_FREQ_HZ : 2.0 * getFrequency (band - 1);
+        }
+    };
+    
+    static_assert (AudiometryBands::size() == NUM_BANDS, "Audiometry bands don't match the loss parameters");
 }
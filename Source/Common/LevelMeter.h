@@ -0,0 +1,335 @@
+/**
+ * \class LevelMeter
+ *
+ * \brief Declaration of LevelMeter interface.
+ * \date  October 2026
+ *
+ * \authors Reactify Music LLP: R. Hrafnkelsson ||
+ * Coordinated by , A. Reyes-Lecuona (University of Malaga) and L.Picinali (Imperial College London) ||
+ * \b Contact: areyes@uma.es and l.picinali@imperial.ac.uk
+ *
+ * \b Project: 3DTI (3D-games for TUNing and lEarnINg about hearing aids) ||
+ * \b Website: http://3d-tune-in.eu/
+ *
+ * \b Copyright: University of Malaga and Imperial College London - 2026
+ *
+ * \b Licence: This copy of the 3D Tune-In Toolkit Plugin is licensed to you under the terms described in the LICENSE.md file included in this distribution.
+ *
+ * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*  Measures the level of a stage of processing for display in an editor.
+
+    The audio thread accumulates peak, mean square and K-weighted mean square
+    over frames of 1 / kUpdateRateHz seconds, whatever the block size, and
+    pushes each finished frame into a single producer, single consumer FIFO.
+    The editor drains the FIFO when it refreshes, so no frame is missed and
+    neither side ever waits for the other.
+ */
+class LevelMeter
+{
+public:
+    //==========================================================================
+    static constexpr int kMaxChannels  = 2;
+    static constexpr int kUpdateRateHz = 30;
+
+    static constexpr float kSilenceLUFS = -100.f;
+
+    struct Levels
+    {
+        float peak[kMaxChannels] {};    // Linear gain
+        float rms[kMaxChannels]  {};    // Linear gain
+        float loudness = kSilenceLUFS;  // Momentary loudness, in LUFS
+    };
+
+    //==========================================================================
+    /** Call before processing starts, e.g. from prepareToPlay() */
+    void prepare (double sampleRate, int numChannels)
+    {
+        mNumChannels = jmin (numChannels, kMaxChannels);
+        mFrameLength = jmax (1, roundToInt (sampleRate / kUpdateRateHz));
+        mFrameSamples = 0;
+        mCurrent = {};
+
+        mWeighted.setSize (mNumChannels, mFrameLength);
+
+        // Approximation of the ITU-R BS.1770 K-weighting pre-filter
+        for (int ch = 0; ch < kMaxChannels; ++ch)
+        {
+            mShelf[ch].setCoefficients (IIRCoefficients::makeHighShelf (sampleRate, 1681.97, 0.7072, Decibels::decibelsToGain (4.f)));
+            mHighPass[ch].setCoefficients (IIRCoefficients::makeHighPass (sampleRate, 38.14, 0.5003));
+            mShelf[ch].reset();
+            mHighPass[ch].reset();
+        }
+
+        mFifo.reset();
+    }
+
+    int getNumChannels() const { return mNumChannels; }
+
+    //==========================================================================
+    /** Measures numSamples of buffer. Call from the audio thread. */
+    void process (const AudioBuffer<float>& buffer, int numSamples)
+    {
+        const int numChannels = jmin (mNumChannels, buffer.getNumChannels());
+
+        if (numChannels == 0)
+            return;
+
+        for (int position = 0; position < numSamples;)
+        {
+            const int n = jmin (numSamples - position, mFrameLength - mFrameSamples);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const float* samples = buffer.getReadPointer (ch, position);
+
+                auto range = FloatVectorOperations::findMinAndMax (samples, n);
+                mCurrent.peak[ch] = jmax (mCurrent.peak[ch], -range.getStart(), range.getEnd());
+                mCurrent.meanSquare[ch] += sumOfSquares (samples, n);
+
+                float* weighted = mWeighted.getWritePointer (ch);
+                FloatVectorOperations::copy (weighted, samples, n);
+                mShelf[ch].processSamples (weighted, n);
+                mHighPass[ch].processSamples (weighted, n);
+                mCurrent.weightedMeanSquare += sumOfSquares (weighted, n);
+            }
+
+            position      += n;
+            mFrameSamples += n;
+
+            if (mFrameSamples == mFrameLength)
+                pushFrame();
+        }
+    }
+
+    //==========================================================================
+    /** Reads every frame measured since the last call. Call from the message thread.
+
+        @returns false if no frames have been measured, e.g. because playback stopped
+     */
+    bool getLevels (Levels& levels)
+    {
+        const int numFrames = mFifo.getNumReady();
+
+        if (numFrames == 0)
+            return false;
+
+        levels = {};
+
+        int start1, size1, start2, size2;
+        mFifo.prepareToRead (numFrames, start1, size1, start2, size2);
+
+        auto accumulate = [&] (int start, int size)
+        {
+            for (int i = start; i < start + size; ++i)
+            {
+                auto const& frame = mFrames[(size_t)i];
+
+                for (int ch = 0; ch < kMaxChannels; ++ch)
+                {
+                    levels.peak[ch] = jmax (levels.peak[ch], frame.peak[ch]);
+                    levels.rms[ch] += frame.meanSquare[ch];
+                }
+
+                mLoudnessHistory[(size_t)mLoudnessIndex] = frame.weightedMeanSquare;
+                mLoudnessIndex = (mLoudnessIndex + 1) % kLoudnessFrames;
+            }
+        };
+
+        accumulate (start1, size1);
+        accumulate (start2, size2);
+        mFifo.finishedRead (size1 + size2);
+
+        for (int ch = 0; ch < kMaxChannels; ++ch)
+            levels.rms[ch] = std::sqrt (levels.rms[ch] / (float)numFrames);
+
+        float weightedMeanSquare = 0.f;
+
+        for (auto value : mLoudnessHistory)
+            weightedMeanSquare += value;
+
+        weightedMeanSquare /= (float)kLoudnessFrames;
+
+        if (weightedMeanSquare > 0.f)
+            levels.loudness = jmax (kSilenceLUFS, -0.691f + 10.f * std::log10 (weightedMeanSquare));
+
+        return true;
+    }
+
+private:
+    //==========================================================================
+    // Momentary loudness is measured over 400 ms
+    static constexpr int kLoudnessFrames = kUpdateRateHz * 400 / 1000;
+
+    // Frames buffered while the editor is closed are dropped once this is full
+    static constexpr int kFifoSize = 64;
+
+    struct Frame
+    {
+        float peak[kMaxChannels]       {};
+        float meanSquare[kMaxChannels] {};
+        float weightedMeanSquare = 0.f;
+    };
+
+    //==========================================================================
+    /** Split into independent partial sums so the loop can be vectorised */
+    static float sumOfSquares (const float* samples, int numSamples)
+    {
+        float sums[4] {};
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+            for (int j = 0; j < 4; ++j)
+                sums[j] += samples[i + j] * samples[i + j];
+
+        for (; i < numSamples; ++i)
+            sums[0] += samples[i] * samples[i];
+
+        return sums[0] + sums[1] + sums[2] + sums[3];
+    }
+
+    void pushFrame()
+    {
+        for (int ch = 0; ch < kMaxChannels; ++ch)
+            mCurrent.meanSquare[ch] /= (float)mFrameLength;
+
+        mCurrent.weightedMeanSquare /= (float)mFrameLength;
+
+        int start1, size1, start2, size2;
+        mFifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 > 0)
+            mFrames[(size_t)start1] = mCurrent;
+
+        mFifo.finishedWrite (size1);
+
+        mCurrent = {};
+        mFrameSamples = 0;
+    }
+
+    //==========================================================================
+    // Audio thread
+    int   mNumChannels  = 0;
+    int   mFrameLength  = 1;
+    int   mFrameSamples = 0;
+    Frame mCurrent;
+
+    AudioBuffer<float> mWeighted;
+    IIRFilter mShelf[kMaxChannels];
+    IIRFilter mHighPass[kMaxChannels];
+
+    // Shared
+    AbstractFifo mFifo {kFifoSize};
+    std::array<Frame, kFifoSize> mFrames;
+
+    // Message thread
+    std::array<float, kLoudnessFrames> mLoudnessHistory {};
+    int mLoudnessIndex = 0;
+};
+
+//==============================================================================
+/*  Horizontal bar per channel showing the RMS level, with a tick at the
+    recent peak, followed by the momentary loudness. Call updateGui() from
+    the editor's refresh.
+ */
+class LevelMeterComponent  : public Component
+{
+public:
+    LevelMeterComponent (LevelMeter& m)
+      : meter (m)
+    {
+        setInterceptsMouseClicks (false, false);
+    }
+
+    //==========================================================================
+    void updateGui()
+    {
+        LevelMeter::Levels levels;
+
+        // Let the display fall back when no audio is being processed
+        if (! meter.getLevels (levels))
+            levels = {};
+
+        bool changed = false;
+
+        for (int ch = 0; ch < LevelMeter::kMaxChannels; ++ch)
+        {
+            auto rms  = jmax (toProportion (levels.rms[ch]),  displayedRms[ch]  - kFallPerUpdate);
+            auto peak = jmax (toProportion (levels.peak[ch]), displayedPeak[ch] - kFallPerUpdate);
+
+            changed |= rms != displayedRms[ch] || peak != displayedPeak[ch];
+
+            displayedRms[ch]  = rms;
+            displayedPeak[ch] = peak;
+        }
+
+        if (levels.loudness != loudness)
+        {
+            loudness = levels.loudness;
+            changed = true;
+        }
+
+        if (changed)
+            repaint();
+    }
+
+    //==========================================================================
+    void paint (Graphics& g) override
+    {
+        const int numChannels = jmax (1, meter.getNumChannels());
+        auto bounds = getLocalBounds().toFloat();
+
+        g.setColour (Colours::white);
+        g.setFont (11.f);
+        g.drawText (loudness > LevelMeter::kSilenceLUFS ? String (loudness, 1) + " LUFS" : String ("-inf LUFS"),
+                    bounds.removeFromRight (kLoudnessWidth),
+                    Justification::centredRight);
+
+        const float rowHeight = bounds.getHeight() / numChannels;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto row = bounds.removeFromTop (rowHeight).reduced (0.f, 1.f);
+
+            g.setColour (Colours::black.withAlpha (0.4f));
+            g.fillRect (row);
+
+            g.setColour (Colours::seagreen);
+            g.fillRect (row.withWidth (row.getWidth() * displayedRms[ch]));
+
+            g.setColour (Colours::white);
+            g.fillRect (row.getX() + row.getWidth() * displayedPeak[ch] - 1.f, row.getY(), 2.f, row.getHeight());
+        }
+    }
+
+private:
+    //==========================================================================
+    static constexpr float kMinDecibels = -60.f;
+    static constexpr float kMaxDecibels = 6.f;
+
+    static constexpr float kLoudnessWidth = 64.f;
+
+    // About 20 dB per second at the meter's update rate
+    static constexpr float kFallPerUpdate = 20.f / (kMaxDecibels - kMinDecibels) / LevelMeter::kUpdateRateHz;
+
+    static float toProportion (float gain)
+    {
+        auto decibels = Decibels::gainToDecibels (gain, kMinDecibels);
+        return jlimit (0.f, 1.f, (decibels - kMinDecibels) / (kMaxDecibels - kMinDecibels));
+    }
+
+    //==========================================================================
+    LevelMeter& meter;
+
+    float displayedRms[LevelMeter::kMaxChannels]  {};
+    float displayedPeak[LevelMeter::kMaxChannels] {};
+    float loudness = LevelMeter::kSilenceLUFS;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeterComponent)
+};
@@ -0,0 +1,106 @@
+/**
+ * \class PluginState
+ *
+ * \brief Declaration of PluginState interface.
+ * \date  October 2026
+ *
+ * \authors Reactify Music LLP: R. Hrafnkelsson ||
+ * Coordinated by , A. Reyes-Lecuona (University of Malaga) and L.Picinali (Imperial College London) ||
+ * \b Contact: areyes@uma.es and l.picinali@imperial.ac.uk
+ *
+ * \b Project: 3DTI (3D-games for TUNing and lEarnINg about hearing aids) ||
+ * \b Website: http://3d-tune-in.eu/
+ *
+ * \b Copyright: University of Malaga and Imperial College London - 2026
+ *
+ * \b Licence: This copy of the 3D Tune-In Toolkit Plugin is licensed to you under the terms described in the LICENSE.md file included in this distribution.
+ *
+ * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*  Binary plugin state shared by all 3DTI plugins.
+
+    The state is a ValueTree written in JUCE's binary format, preceded by a
+    small header so that chunks from other plugins or newer versions are
+    rejected instead of being half applied.
+ */
+namespace PluginState
+{
+    static constexpr int kMagic   = 0x33445449; // "3DTI"
+    static constexpr int kVersion = 1;
+
+    static const Identifier kParameter ("PARAM");
+    static const Identifier kId        ("id");
+    static const Identifier kValue     ("value");
+
+    //==========================================================================
+    static inline void write (const ValueTree& state, MemoryBlock& destData)
+    {
+        MemoryOutputStream stream (destData, false);
+        stream.writeInt (kMagic);
+        stream.writeInt (kVersion);
+        state.writeToStream (stream);
+    }
+
+    /** @returns the stored state, or an invalid tree if the data wasn't written
+                 by write() or comes from a newer version of the plugin
+     */
+    static inline ValueTree read (const void* data, int sizeInBytes)
+    {
+        if (data == nullptr || sizeInBytes < 2 * (int)sizeof (int))
+            return {};
+
+        MemoryInputStream stream (data, (size_t)sizeInBytes, false);
+
+        if (stream.readInt() != kMagic)
+            return {};
+
+        if (stream.readInt() > kVersion)
+            return {};
+
+        return ValueTree::readFromStream (stream);
+    }
+
+    //==========================================================================
+    /** Stores the normalised value of every parameter of a processor that
+        doesn't use an AudioProcessorValueTreeState. The layout matches the
+        PARAM children of AudioProcessorValueTreeState.
+     */
+    static inline ValueTree fromParameters (const Identifier& type, AudioProcessor& processor)
+    {
+        ValueTree state (type);
+
+        for (auto* parameter : processor.getParameters())
+        {
+            if (auto* p = dynamic_cast<AudioProcessorParameterWithID*> (parameter))
+            {
+                ValueTree child (kParameter);
+                child.setProperty (kId, p->paramID, nullptr);
+                child.setProperty (kValue, p->getValue(), nullptr);
+                state.appendChild (child, nullptr);
+            }
+        }
+
+        return state;
+    }
+
+    /** Applies values stored by fromParameters(). Parameters missing from the state keep their current value. */
+    static inline void toParameters (const ValueTree& state, AudioProcessor& processor)
+    {
+        for (auto* parameter : processor.getParameters())
+        {
+            if (auto* p = dynamic_cast<AudioProcessorParameterWithID*> (parameter))
+            {
+                auto child = state.getChildWithProperty (kId, p->paramID);
+
+                if (child.isValid())
+                    p->setValueNotifyingHost ((float)child[kValue]);
+            }
+        }
+    }
+}
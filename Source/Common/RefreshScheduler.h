@@ -0,0 +1,193 @@
+/**
+ * \class RefreshScheduler
+ *
+ * \brief Declaration of RefreshScheduler interface.
+ * \date  October 2026
+ *
+ * \authors Reactify Music LLP: R. Hrafnkelsson ||
+ * Coordinated by , A. Reyes-Lecuona (University of Malaga) and L.Picinali (Imperial College London) ||
+ * \b Contact: areyes@uma.es and l.picinali@imperial.ac.uk
+ *
+ * \b Project: 3DTI (3D-games for TUNing and lEarnINg about hearing aids) ||
+ * \b Website: http://3d-tune-in.eu/
+ *
+ * \b Copyright: University of Malaga and Imperial College London - 2026
+ *
+ * \b Licence: This copy of the 3D Tune-In Toolkit Plugin is licensed to you under the terms described in the LICENSE.md file included in this distribution.
+ *
+ * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
+ */
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Set to 1 to show the average cost of the refresh in every editor
+#ifndef TDTI_SHOW_REFRESH_COST
+ #define TDTI_SHOW_REFRESH_COST 0
+#endif
+
+//==============================================================================
+/*  Drives the periodic GUI refresh of a plugin editor.
+
+    All of an editor's components are updated from one callback, paced by the
+    display's vertical blank where JUCE supports it (JUCE 7 and later) and by
+    a single timer shared between every open editor otherwise. Either way the
+    callback is throttled to the requested rate and skipped entirely while
+    the editor isn't showing, e.g. when its window is closed or minimised.
+
+    With TDTI_SHOW_REFRESH_COST set, the average cost of the callback is
+    shown in the bottom left corner of the editor.
+ */
+class RefreshScheduler  : private ComponentListener
+{
+public:
+    //==========================================================================
+    RefreshScheduler (Component& editor, std::function<void()> refresh, int frameRateHz = 30)
+      : mEditor (editor),
+        mRefresh (std::move (refresh)),
+        mIntervalMs (1000.0 / frameRateHz)
+    {
+        jassert (frameRateHz > 0 && frameRateHz <= kClockRateHz);
+
+       #if JUCE_MAJOR_VERSION >= 7
+        mVBlank = std::make_unique<VBlankAttachment> (&mEditor, [this] { tick(); });
+       #else
+        mClock->add (this);
+       #endif
+
+       #if TDTI_SHOW_REFRESH_COST
+        mFrameCostLabel.setFont (Font (11.f));
+        mFrameCostLabel.setColour (Label::textColourId, Colours::yellow);
+        mFrameCostLabel.setColour (Label::backgroundColourId, Colours::black.withAlpha (0.6f));
+        mFrameCostLabel.setInterceptsMouseClicks (false, false);
+        mFrameCostLabel.setAlwaysOnTop (true);
+        mEditor.addAndMakeVisible (mFrameCostLabel);
+        mEditor.addComponentListener (this);
+        placeFrameCostLabel();
+       #endif
+    }
+
+    ~RefreshScheduler() override
+    {
+       #if JUCE_MAJOR_VERSION >= 7
+        mVBlank.reset();
+       #else
+        mClock->remove (this);
+       #endif
+
+       #if TDTI_SHOW_REFRESH_COST
+        mEditor.removeComponentListener (this);
+        mEditor.removeChildComponent (&mFrameCostLabel);
+       #endif
+    }
+
+private:
+    //==========================================================================
+    // Rate of the shared fallback clock, the highest refresh rate supported
+    static constexpr int kClockRateHz = 60;
+
+    // Allowance for jitter in the vblank or timer callbacks
+    static constexpr double kSlackMs = 4.0;
+
+    // Number of refreshes between updates of the frame cost label
+    static constexpr int kFrameCostPeriod = 15;
+
+    //==========================================================================
+    void tick()
+    {
+        // isShowing() is also false while the top level window is minimised
+        if (! mEditor.isShowing())
+            return;
+
+        auto now = Time::getMillisecondCounterHiRes();
+
+        if (now - mLastRefreshMs < mIntervalMs - kSlackMs)
+            return;
+
+        mLastRefreshMs = now;
+        mRefresh();
+
+       #if TDTI_SHOW_REFRESH_COST
+        updateFrameCost (Time::getMillisecondCounterHiRes() - now);
+       #endif
+    }
+
+   #if TDTI_SHOW_REFRESH_COST
+    void updateFrameCost (double costMs)
+    {
+        mAverageCostMs += 0.1 * (costMs - mAverageCostMs);
+
+        if (++mFramesSinceLabelUpdate < kFrameCostPeriod)
+            return;
+
+        mFramesSinceLabelUpdate = 0;
+        mFrameCostLabel.setText (String (mAverageCostMs, 2) + " ms", dontSendNotification);
+    }
+
+    void placeFrameCostLabel()
+    {
+        mFrameCostLabel.setBounds (0, mEditor.getHeight() - 16, 60, 16);
+    }
+
+    /** ComponentListener */
+    void componentMovedOrResized (Component&, bool, bool wasResized) override
+    {
+        if (wasResized)
+            placeFrameCostLabel();
+    }
+   #endif
+
+    //==========================================================================
+    /** Ticks every editor from a single timer when vblank callbacks aren't available */
+    class SharedClock  : private Timer
+    {
+    public:
+        void add (RefreshScheduler* scheduler)
+        {
+            mSchedulers.addIfNotAlreadyThere (scheduler);
+
+            if (! isTimerRunning())
+                startTimerHz (kClockRateHz);
+        }
+
+        void remove (RefreshScheduler* scheduler)
+        {
+            mSchedulers.removeFirstMatchingValue (scheduler);
+
+            if (mSchedulers.isEmpty())
+                stopTimer();
+        }
+
+    private:
+        void timerCallback() override
+        {
+            for (auto* scheduler : mSchedulers)
+                scheduler->tick();
+        }
+
+        Array<RefreshScheduler*> mSchedulers;
+    };
+
+    //==========================================================================
+    Component&            mEditor;
+    std::function<void()> mRefresh;
+
+    const double mIntervalMs;
+    double       mLastRefreshMs = 0.0;
+
+   #if JUCE_MAJOR_VERSION >= 7
+    std::unique_ptr<VBlankAttachment> mVBlank;
+   #else
+    SharedResourcePointer<SharedClock> mClock;
+   #endif
+
+   #if TDTI_SHOW_REFRESH_COST
+    Label  mFrameCostLabel;
+    double mAverageCostMs = 0.0;
+    int    mFramesSinceLabelUpdate = 0;
+   #endif
+
+    //==========================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RefreshScheduler)
+};
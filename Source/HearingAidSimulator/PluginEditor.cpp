@@ -28,7 +28,8 @@ HASPluginAudioProcessorEditor::HASPluginAudioProcessorEditor (HASPluginAudioProc
   : AudioProcessorEditor(&p),
     processor(p),
     channelSettingsComponent (p),
-    dynamicEQComponent (p)
+    dynamicEQComponent (p),
+    refreshScheduler (*this, [this] { updateGui(); })
 {
     aboutText.setMultiLine(true);
     aboutText.setFont(Font(16.0f, Font::plain));
@@ -54,15 +55,12 @@ HASPluginAudioProcessorEditor::HASPluginAudioProcessorEditor (HASPluginAudioProc
     addChildComponent (aboutText);
     
     setSize (800, 960);
-    
-    startTimer (30);
 }
 
 HASPluginAudioProcessorEditor::~HASPluginAudioProcessorEditor() {
-    stopTimer();
 }
 
-void HASPluginAudioProcessorEditor::timerCallback()
+void HASPluginAudioProcessorEditor::updateGui()
 {
     channelSettingsComponent.updateGUIState();
     dynamicEQComponent.updateGUIState();
@@ -26,13 +26,13 @@
 #include "DynamicEQComponent.h"
 #include "Common/AboutBanner.h"
 #include "Common/AudiogramComponent.h"
+#include "Common/RefreshScheduler.h"
 
 //==============================================================================
 /**
  */
 class HASPluginAudioProcessorEditor : public AudioProcessorEditor,
-                                      public AudiogramComponent::Listener,
-                                      public Timer
+                                      public AudiogramComponent::Listener
 {
 public:
     HASPluginAudioProcessorEditor (HASPluginAudioProcessor&);
@@ -42,7 +42,7 @@ public:
     void paint (Graphics&) override;
     void resized() override;
     
-    void timerCallback() override;
+    void updateGui();
     
     void mouseUp (const MouseEvent &e) override {
         aboutText.setVisible(false);
@@ -62,5 +62,7 @@ private:
     std::unique_ptr<AudiogramComponent> audiogramComponent;
     DynamicEQComponent dynamicEQComponent;
     
+    RefreshScheduler refreshScheduler;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HASPluginAudioProcessorEditor)
 };
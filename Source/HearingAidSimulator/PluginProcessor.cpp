@@ -18,12 +18,11 @@
  * \b Acknowledgement: This project has received funding from the European Union's Horizon 2020 research and innovation programme under grant agreements No 644051 and 726765.
  */
 
-#include <HAHLSimulation/ButterworthMultibandExpander.h>
 #include "../Common/Constants.h"
+#include "../Common/PluginState.h"
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-#define NUM_LEVELS 3
 #define INITIAL_FREQ_HZ   125
 #define OCTAVE_BAND_STEP  1
 #define Q_BAND_PASS_FILTERS 1.4142
@@ -33,6 +32,11 @@
 
 #define dBs_SPL_for_0_dBs_fs 100.0f
 
+// The simulator always processes blocks of this size, whatever the host sends
+static constexpr int kINTERNAL_BLOCK_SIZE = 512;
+
+static const Identifier kStateType ("3DTI Hearing Aid Simulator Parameters");
+
 //==============================================================================
 HASPluginAudioProcessor::HASPluginAudioProcessor()
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -161,6 +165,23 @@ HASPluginAudioProcessor::HASPluginAudioProcessor()
     addParameter (dynamicEQRelease[1] = new AudioParameterInt ("dynamic_eq_release_right", "Release Right", 0, 2000, 1000));
     addParameter (dynamicEQCompressionPct[0] = new AudioParameterInt ("dynamic_eq_compression_pct_left", "Comp Pct Left", 0, 120, 100));
     addParameter (dynamicEQCompressionPct[1] = new AudioParameterInt ("dynamic_eq_compression_pct_right", "Comp Pct Right", 0, 120, 100));
+    
+    // Fig6 is only refitted when one of these changes
+    hearingLossLink->addListener (this);
+    dynamicEQLink->addListener (this);
+    
+    for (int channel = 0; channel < 2; channel++)
+    {
+        enableFig6[channel]->addListener (this);
+        
+        for (int band = 0; band < Constants::NUM_BANDS; band++)
+            hearingLoss[channel][band]->addListener (this);
+        
+        for (auto* threshold : dynamicEQThresholds[channel])
+            threshold->addListener (this);
+    }
+    
+    startTimerHz (30);
 }
 
 HASPluginAudioProcessor::~HASPluginAudioProcessor()
@@ -238,17 +259,23 @@ void HASPluginAudioProcessor::changeProgramName (int index, const String& newNam
 //==============================================================================
 void HASPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // HL Simulator Setup
-    // TODO: Abstract into separate class
-    hlSimulator.Setup ((int)sampleRate, 100, 9, samplesPerBlock);
+    auto const maxChannels = std::max (getTotalNumInputChannels(), getTotalNumOutputChannels());
     
-    for (int i = 0; i < 2; i++)
-    {
-        auto butterWorthExpander = make_shared<HAHLSimulation::CButterworthMultibandExpander>();
-        butterWorthExpander->Setup ((int)getSampleRate(), HL_INITIAL_FREQ_HZ, HL_BANDS_NUMBER, true);
-        butterWorthExpander->SetNumberOfFiltersPerBand (HL_FILTERS_PER_BAND);
-        hlSimulator.SetMultibandExpander (ears[i], butterWorthExpander);
-    }
+    auto const blockSizeInternal = kINTERNAL_BLOCK_SIZE;
+    inFifo.clear();
+    inFifo.setSize (maxChannels, blockSizeInternal + samplesPerBlock);
+    
+    outFifo.clear();
+    outFifo.setSize (maxChannels, blockSizeInternal * 2 + samplesPerBlock);
+    
+    scratchBuffer.setSize (maxChannels, blockSizeInternal);
+    
+    // Less than one internal block can be waiting in the input FIFO,
+    // so priming the output with that much silence means every host
+    // block can be filled, whatever its size
+    auto const latency = blockSizeInternal - 1;
+    outFifo.addSilenceToFifo (latency);
+    setLatencySamples (latency);
     
     // HA Simulator Setup
     simulator.Setup ((int)sampleRate,
@@ -262,8 +289,15 @@ void HASPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
                      Q_BAND_PASS_FILTERS,
                      Q_HIGH_PASS_FILTER);
     
-    bIn.left .assign (samplesPerBlock, 0.0f);
-    bIn.right.assign (samplesPerBlock, 0.0f);
+    // The Fig6 fitter belongs to the message thread, which sets it up
+    fig6SampleRate = (int)sampleRate;
+    
+    // Set up buffers
+    bIn.left .assign (blockSizeInternal, 0.0f);
+    bIn.right.assign (blockSizeInternal, 0.0f);
+    
+    bOut.left .assign (blockSizeInternal, 0.0f);
+    bOut.right.assign (blockSizeInternal, 0.0f);
 }
 
 void HASPluginAudioProcessor::releaseResources() {
@@ -309,7 +343,7 @@ void HASPluginAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuff
     // We currently assume working in stereo
     jassert (buffer.getNumChannels() >= 2);
     
-    int numSamples = buffer.getNumSamples();
+    const int numSamples = buffer.getNumSamples();
 
     if (enableQuantisationPre->get())
         simulator.EnableQuantizationBeforeEqualizer();
@@ -329,6 +363,8 @@ void HASPluginAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuff
     float hiPassCutoff = dynamicEQHiPassCutoff->get() * dynamicEQHiPassEnabled->get();
     simulator.SetHighPassFilter (hiPassCutoff, Q_HIGH_PASS_FILTER);
     
+    fig6InUse.store (true);
+    
     for (int i = 0; i < 2; i++)
     {
         int channel = channelLink->get() ? 0 : i;
@@ -342,26 +378,7 @@ void HASPluginAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuff
         
         auto dynEQChannel = dynamicEQLink->get() ? 0 : i;
         
-        if (enableFig6[dynEQChannel]->get())
-        {
-            std::vector<float> losses;
-            
-            int lossChannel = dynamicEQLink->get() || hearingLossLink->get() ? 0 : dynEQChannel;
-            
-            static constexpr int firstBandOfInterest = 1;
-            
-            for (int band = firstBandOfInterest; band < BANDS_NUMBER + firstBandOfInterest; band++)
-                losses.push_back (hearingLoss[lossChannel][band]->get());
-            
-            simulator.SetDynamicEqualizerUsingFig6 (ears[i], losses, dBs_SPL_for_0_dBs_fs);
-            
-            auto* dynamicEQ = simulator.GetDynamicEqualizer (ears[i]);
-            for (int y = 0; y < BANDS_NUMBER; y++)
-                for (int i = 0; i < NUM_LEVELS; i++)
-                    *(dynamicEQBandGains[dynEQChannel][y]->getUnchecked (i)) = dynamicEQ->GetLevelBandGain_dB (i, y);
-            
-            *enableFig6[dynEQChannel] = false;
-        }
+        auto const* fig6 = fig6Gains[dynEQChannel].load();
         
         auto* dynamicEQ = simulator.GetDynamicEqualizer (ears[i]);
         for (int level = 0; level < NUM_LEVELS; level++)
@@ -370,7 +387,11 @@ void HASPluginAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuff
             dynamicEQ->SetLevelThreshold (level, threshold);
             
             for (int band = 0; band < BANDS_NUMBER; band++)
-                dynamicEQ->SetLevelBandGain_dB (level, band, dynamicEQBandGains[dynEQChannel][band]->getUnchecked(level)->get());
+            {
+                auto gain = fig6 != nullptr ? fig6->bandGains[band][level]
+                                            : dynamicEQBandGains[dynEQChannel][band]->getUnchecked(level)->get();
+                dynamicEQ->SetLevelBandGain_dB (level, band, gain);
+            }
         }
         
         dynamicEQ->SetAttack_ms (dynamicEQAttack[dynEQChannel]->get());
@@ -380,20 +401,50 @@ void HASPluginAudioProcessor::processBlock (AudioBuffer<float>& buffer, MidiBuff
         simulator.DisableNormalization (ears[i]);
     }
     
-    // Fill input buffer and clear output
-    for (int i = 0; i < numSamples; i++)
+    fig6InUse.store (false);
+    
+    inFifo.addToFifo (buffer);
+    
+    const int blockSizeInternal = kINTERNAL_BLOCK_SIZE;
+    
+    while (inFifo.getNumReady() >= blockSizeInternal)
     {
-        bIn.left[i]  = buffer.getReadPointer (0)[i];
-        bIn.right[i] = buffer.getReadPointer (1)[i];
+        inFifo.readFromFifo (scratchBuffer);
+        
+        processBlockInternal (scratchBuffer);
+        
+        outFifo.addToFifo (scratchBuffer);
     }
     
-    simulator.Process (bIn, bOut);
-
-    for (int i = 0; i < numSamples; i++)
+    int numReady = outFifo.getNumReady();
+    if (numReady < numSamples)
     {
-        buffer.getWritePointer (0)[i] = bOut.left[i];
-        buffer.getWritePointer (1)[i] = bOut.right[i];
+        // Only happens if the host sends more than it announced in prepareToPlay
+        int diff = numSamples - numReady;
+        outFifo.addSilenceToFifo (diff);
+        
+        // Update the host latency
+        int latency = getLatencySamples() + diff;
+        setLatencySamples (latency);
     }
+    
+    outFifo.readFromFifo (buffer);
+}
+
+void HASPluginAudioProcessor::processBlockInternal (AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    
+    jassert (bIn.left.size()  >= numSamples);
+    jassert (bOut.left.size() >= numSamples);
+    
+    FloatVectorOperations::copy (bIn.left .data(), buffer.getReadPointer (0), numSamples);
+    FloatVectorOperations::copy (bIn.right.data(), buffer.getReadPointer (1), numSamples);
+    
+    simulator.Process (bIn, bOut);
+    
+    FloatVectorOperations::copy (buffer.getWritePointer (0), bOut.left.data(),  numSamples);
+    FloatVectorOperations::copy (buffer.getWritePointer (1), bOut.right.data(), numSamples);
 }
 
 //==============================================================================
@@ -410,16 +461,139 @@ AudioProcessorEditor* HASPluginAudioProcessor::createEditor()
 //==============================================================================
 void HASPluginAudioProcessor::getStateInformation (MemoryBlock& destData)
 {
+    PluginState::write (PluginState::fromParameters (kStateType, *this), destData);
 }
 
 void HASPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    auto state = PluginState::read (data, sizeInBytes);
+    
+    if (! state.hasType (kStateType))
+        return;
+    
+    // Apply the whole state before the next block is processed
+    suspendProcessing (true);
+    PluginState::toParameters (state, *this);
+    suspendProcessing (false);
 }
 
 void HASPluginAudioProcessor::parameterChanged(const String& parameterID, float newValue)
 {
 }
 
+//==============================================================================
+// Timer ticks a prescription stays published if the band gain parameters
+// never catch up with it, e.g. because host automation overrides them
+static constexpr int kFig6MaxPublishedTicks = 30;
+
+void HASPluginAudioProcessor::timerCallback()
+{
+    // A prescription is withdrawn once the parameters hold the same gains
+    for (int channel = 0; channel < 2; channel++)
+    {
+        auto const* table = fig6Gains[channel].load();
+        
+        if (table == nullptr)
+            continue;
+        
+        if (hasCaughtUp (channel, *table) || ++fig6PublishedTicks[channel] >= kFig6MaxPublishedTicks)
+            fig6Gains[channel].store (nullptr);
+    }
+    
+    auto sampleRate = fig6SampleRate.load();
+    
+    if (sampleRate == 0)
+        return;
+    
+    if (sampleRate != fig6FitterRate)
+    {
+        fig6Fitter.Setup (sampleRate,
+                          NUM_LEVELS,
+                          INITIAL_FREQ_HZ,
+                          BANDS_NUMBER,
+                          OCTAVE_BAND_STEP,
+                          CUTOFF_FREQ_LPF_Hz,
+                          CUTOFF_FREQ_HPF_Hz,
+                          Q_LOW_PASS_FILTER,
+                          Q_BAND_PASS_FILTERS,
+                          Q_HIGH_PASS_FILTER);
+        
+        fig6FitterRate = sampleRate;
+    }
+    
+    // A reader may still be on the table a refit would overwrite, so the
+    // refit waits for the next tick. Blocks are far shorter than a tick.
+    if (fig6InUse.load() || ! fig6Dirty.exchange (false))
+        return;
+    
+    for (int channel = 0; channel < 2; channel++)
+    {
+        // The right settings aren't used while the dynamic EQ is linked
+        if (channel == 1 && dynamicEQLink->get())
+            break;
+        
+        if (enableFig6[channel]->get())
+            fitFig6 (channel);
+    }
+}
+
+void HASPluginAudioProcessor::fitFig6 (int channel)
+{
+    std::vector<float> losses;
+    
+    int lossChannel = dynamicEQLink->get() || hearingLossLink->get() ? 0 : channel;
+    
+    static constexpr int firstBandOfInterest = 1;
+    
+    for (int band = firstBandOfInterest; band < BANDS_NUMBER + firstBandOfInterest; band++)
+        losses.push_back (hearingLoss[lossChannel][band]->get());
+    
+    auto* dynamicEQ = fig6Fitter.GetDynamicEqualizer (ears[channel]);
+    for (int level = 0; level < NUM_LEVELS; level++)
+        dynamicEQ->SetLevelThreshold (level, dynamicEQThresholds[channel][level]->get());
+    
+    fig6Fitter.SetDynamicEqualizerUsingFig6 (ears[channel], losses, dBs_SPL_for_0_dBs_fs);
+    
+    auto& table = fig6Tables[channel][fig6NextTable[channel]];
+    fig6NextTable[channel] ^= 1;
+    
+    for (int band = 0; band < BANDS_NUMBER; band++)
+        for (int level = 0; level < NUM_LEVELS; level++)
+            table.bandGains[band][level] = dynamicEQ->GetLevelBandGain_dB (level, band);
+    
+    // Hand the whole prescription to the audio thread at once
+    fig6Gains[channel].store (&table);
+    fig6PublishedTicks[channel] = 0;
+    
+    // Then bring the parameters in line, as a single gesture per changed gain
+    for (int band = 0; band < BANDS_NUMBER; band++)
+    {
+        for (int level = 0; level < NUM_LEVELS; level++)
+        {
+            auto* gain = dynamicEQBandGains[channel][band]->getUnchecked (level);
+            
+            if (gain->get() == table.bandGains[band][level])
+                continue;
+            
+            gain->beginChangeGesture();
+            *gain = table.bandGains[band][level];
+            gain->endChangeGesture();
+        }
+    }
+    
+    *enableFig6[channel] = false;
+}
+
+bool HASPluginAudioProcessor::hasCaughtUp (int channel, const Fig6Gains& table) const
+{
+    for (int band = 0; band < BANDS_NUMBER; band++)
+        for (int level = 0; level < NUM_LEVELS; level++)
+            if (std::abs (dynamicEQBandGains[channel][band]->getUnchecked (level)->get() - table.bandGains[band][level]) > 0.01f)
+                return false;
+    
+    return true;
+}
+
 //==============================================================================
 // This creates new instances of the plugin..
 AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -21,9 +21,12 @@
 #pragma once
 
 #include <HAHLSimulation/3DTI_HAHLSimulator.h>
+#include <ff_buffers/ff_buffers_AudioBufferFIFO.h>
 #include <JuceHeader.h>
+#include "../Common/Constants.h"
 
 static constexpr int BANDS_NUMBER = 7;
+static constexpr int NUM_LEVELS   = 3;
 #define Q_HIGH_PASS_FILTER  0.707
 #define Q_LOW_PASS_FILTER   0.707
 
@@ -32,7 +35,7 @@ static Common::T_ear ears[2] = {Common::T_ear::LEFT, Common::T_ear::RIGHT};
 //==============================================================================
 /**
  */
-class HASPluginAudioProcessor  : public AudioProcessor, private AudioProcessorValueTreeState::Listener, private Timer
+class HASPluginAudioProcessor  : public AudioProcessor, private AudioProcessorValueTreeState::Listener, private AudioProcessorParameter::Listener, private Timer
 {
 public:
     //==============================================================================
@@ -97,8 +100,8 @@ public:
     juce::Array<int> getBandFrequenciesAudiometry()
     {
         juce::Array<int> bands;
-        for (int i = 0; i < hlSimulator.GetNumberOfBands(); i++)
-            bands.add (hlSimulator.GetBandFrequency (i));
+        for (int i = 0; i < Constants::AudiometryBands::size(); i++)
+            bands.add ((int)Constants::AudiometryBands::getFrequency (i));
         return bands;
     }
     
@@ -119,12 +122,55 @@ private:
         return simulator.GetDynamicEqualizer (ears[channel]);
     }
     
+    void processBlockInternal (AudioBuffer<float>&);
+    
+    //==============================================================================
     Common::CEarPair<CMonoBuffer<float>>  bIn;
     Common::CEarPair<CMonoBuffer<float>>  bOut;
+    
+    AudioBuffer<float>     scratchBuffer;
+    AudioBufferFIFO<float> inFifo  {2, 512},
+                           outFifo {2, 512};
+    
     HAHLSimulation::CHearingAidSim  simulator;
-    HAHLSimulation::CHearingLossSim hlSimulator; // Used for Audiometry only
     
-    void timerCallback() override {}
+    //==============================================================================
+    /** Dynamic EQ gains prescribed by Fig6, in dB */
+    struct Fig6Gains
+    {
+        float bandGains[BANDS_NUMBER][NUM_LEVELS];
+    };
+    
+    void fitFig6 (int channel);
+    bool hasCaughtUp (int channel, const Fig6Gains& table) const;
+    
+    // Only used on the message thread, to compute Fig6 prescriptions. The
+    // timer sets it up again whenever prepareToPlay() reports a new rate.
+    HAHLSimulation::CHearingAidSim fig6Fitter;
+    int                            fig6FitterRate = 0;
+    std::atomic<int>               fig6SampleRate {0};
+    
+    // Set when a parameter a prescription depends on changes
+    std::atomic<bool> fig6Dirty {true};
+    
+    // Each channel alternates between two tables, so the audio thread can
+    // finish with one while the next prescription is written to the other.
+    // The audio thread holds fig6InUse while it reads the gains, and a table
+    // is only rewritten once it's clear, so no reader can still be on it.
+    Fig6Gains         fig6Tables[2][2];
+    int               fig6NextTable[2] = {0, 0};
+    std::atomic<bool> fig6InUse {false};
+    
+    // The latest prescription, used by the audio thread until the band
+    // gain parameters have caught up with it
+    std::atomic<const Fig6Gains*> fig6Gains[2] {{nullptr}, {nullptr}};
+    int fig6PublishedTicks[2] = {0, 0};
+    
+    void timerCallback() override;
+    
+    /** AudioProcessorParameter::Listener, for the parameters Fig6 depends on */
+    void parameterValueChanged (int, float) override { fig6Dirty = true; }
+    void parameterGestureChanged (int, bool) override {}
     
     void parameterChanged(const String& parameterID, float newValue) override;
     
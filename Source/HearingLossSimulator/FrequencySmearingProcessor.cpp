@@ -22,13 +22,6 @@
 
 static Common::T_ear ears[2] = {Common::T_ear::LEFT, Common::T_ear::RIGHT};
 
-//==============================================================================
-template <typename Type>
-static bool compare (Type one, Type two)
-{
-    return (std::abs (one - two) > std::numeric_limits<Type>::epsilon());
-}
-
 //==============================================================================
 FrequencySmearingProcessor::FrequencySmearingProcessor (HAHLSimulation::CHearingLossSim& sim)
   :  simulator (sim)
@@ -100,84 +93,101 @@ FrequencySmearingProcessor::FrequencySmearingProcessor (HAHLSimulation::CHearing
                                                                     [] (const String& text) { return text.getFloatValue(); });
         channels.add (new Channel);
     }
+    
+    listenForChanges (freqSmearLink, 0, kAllChanged);
+    listenForChanges (freqSmearLink, 1, kAllChanged);
+    
+    for (int i = 0; i < 2; i++)
+    {
+        // Left settings also apply to the right ear while linked
+        for (int ear = i; ear < 2; ear++)
+        {
+            listenForChanges (freqSmearEnabled[i],                 ear, kEnabledChanged);
+            listenForChanges (freqSmearType[i],                    ear, kTypeChanged);
+            listenForChanges (freqSmearSpectralBroadFactorUp[i],   ear, kBroadFactorUpChanged);
+            listenForChanges (freqSmearSpectralBroadFactorDown[i], ear, kBroadFactorDownChanged);
+            listenForChanges (freqSmearSpectralFrequencyDown[i],   ear, kFrequencyDownChanged);
+            listenForChanges (freqSmearSpectralFrequencyUp[i],     ear, kFrequencyUpChanged);
+            listenForChanges (freqSmearSpectralBufferSizeDown[i],  ear, kBufferSizeDownChanged);
+            listenForChanges (freqSmearSpectralBufferSizeUp[i],    ear, kBufferSizeUpChanged);
+        }
+    }
+}
+
+void FrequencySmearingProcessor::listenForChanges (AudioProcessorParameter* parameter, int ear, uint32 flags)
+{
+    changeListeners.add (new ChangeListener (*parameter, changedSettings, earFlags (ear, flags)));
 }
 
 void FrequencySmearingProcessor::updateSettingsIfNeeded()
 {
+    auto changed = changedSettings.exchange (0);
+    
+    if (changed == 0)
+        return;
+    
     for (int ch = 0; ch < getChannels().size(); ch++)
     {
+        uint32 flags = (changed >> (8 * ch)) & kAllChanged;
+        
+        if (flags == 0)
+            continue;
+        
         int channel = (! freqSmearLink->get()) * ch;
+        int type = freqSmearType[channel]->get() ? FrequencySmearType::Graf3dti : FrequencySmearType::BaerMoore;
         
-        if (freqSmearType[channel]->get() == FrequencySmearType::BaerMoore)
+        // Only hand a smearer to the simulator when the type changes
+        if (type != activeType[ch])
         {
-            auto baerMooreSmearing = dynamic_pointer_cast<CBaerMooreFrequencySmearing> (simulator.GetFrequencySmearingSimulator (ears[ch]));
-            
-            if (! baerMooreSmearing)
-            {
+            if (type == FrequencySmearType::BaerMoore)
                 simulator.SetFrequencySmearer (ears[ch], channels[ch]->baerMooreSmearing);
-                baerMooreSmearing = dynamic_pointer_cast<CBaerMooreFrequencySmearing> (simulator.GetFrequencySmearingSimulator (ears[ch]));
-            }
-    
-            float value = freqSmearSpectralBroadFactorUp[channel]->get();
-            if (compare (value, previousSpectralBroadFactorUp[ch]))
-            {
-                baerMooreSmearing->SetUpwardBroadeningFactor (value);
-                previousSpectralBroadFactorUp[ch] = value;
-            }
-    
-            value = freqSmearSpectralBroadFactorDown[channel]->get();
-            if (compare (value, previousSpectralBroadFactorDown[ch]))
-            {
-                baerMooreSmearing->SetDownwardBroadeningFactor (value);
-                previousSpectralBroadFactorDown[ch] = freqSmearSpectralBroadFactorDown[channel]->get();
-            }
+            else
+                simulator.SetFrequencySmearer (ears[ch], channels[ch]->graf3dtiSmearing);
+            
+            activeType[ch] = type;
+            
+            flags |= deferredChanges[ch];
+            deferredChanges[ch] = 0;
         }
-        else
+        
+        if (type == FrequencySmearType::BaerMoore)
         {
-            // Graf & 3dti
-            auto graf3dtiSmearing = dynamic_pointer_cast<HAHLSimulation::CGraf3DTIFrequencySmearing> (simulator.GetFrequencySmearingSimulator (ears[ch]));
+            auto const& baerMooreSmearing = channels[ch]->baerMooreSmearing;
             
-            if (! graf3dtiSmearing)
-            {
-                simulator.SetFrequencySmearer (ears[ch], channels[ch]->graf3dtiSmearing);
-                graf3dtiSmearing = dynamic_pointer_cast<CGraf3DTIFrequencySmearing> (simulator.GetFrequencySmearingSimulator (ears[ch]));
-            }
+            if (flags & kBroadFactorUpChanged)
+                baerMooreSmearing->SetUpwardBroadeningFactor (freqSmearSpectralBroadFactorUp[channel]->get());
             
-            simulator.SetFrequencySmearer (ears[ch], dynamic_pointer_cast<CFrequencySmearing> (channels[ch]->graf3dtiSmearing));
+            if (flags & kBroadFactorDownChanged)
+                baerMooreSmearing->SetDownwardBroadeningFactor (freqSmearSpectralBroadFactorDown[channel]->get());
             
-            float value = freqSmearSpectralFrequencyDown[channel]->get();
-            if (compare (previousSpectralFrequencyDown[ch], value))
-            {
-                graf3dtiSmearing->SetDownwardSmearing_Hz (value);
-                previousSpectralFrequencyDown[ch] = value;
-            }
+            deferredChanges[ch] |= flags & kGraf3dtiChanged;
+        }
+        else
+        {
+            auto const& graf3dtiSmearing = channels[ch]->graf3dtiSmearing;
+            
+            if (flags & kFrequencyDownChanged)
+                graf3dtiSmearing->SetDownwardSmearing_Hz (freqSmearSpectralFrequencyDown[channel]->get());
             
-            value = freqSmearSpectralFrequencyUp[channel]->get();
-            if (compare (previousSpectralFrequencyUp[ch], value))
-            {
-                graf3dtiSmearing->SetUpwardSmearing_Hz (value);
-                previousSpectralFrequencyUp[ch] = value;
-            }
+            if (flags & kFrequencyUpChanged)
+                graf3dtiSmearing->SetUpwardSmearing_Hz (freqSmearSpectralFrequencyUp[channel]->get());
             
-            value = freqSmearSpectralBufferSizeDown[channel]->get();
-            if (compare (previousSpectralBufferSizeDown[ch], value))
-            {
-                graf3dtiSmearing->SetDownwardSmearingBufferSize ((int)value);
-                previousSpectralBufferSizeDown[ch] = value;
-            }
+            if (flags & kBufferSizeDownChanged)
+                graf3dtiSmearing->SetDownwardSmearingBufferSize ((int)freqSmearSpectralBufferSizeDown[channel]->get());
             
-            value = freqSmearSpectralBufferSizeUp[channel]->get();
-            if (compare (previousSpectralBufferSizeUp[ch], value))
-            {
-                graf3dtiSmearing->SetUpwardSmearingBufferSize ((int)value);
-                previousSpectralBufferSizeUp[ch] = value;
-            }
+            if (flags & kBufferSizeUpChanged)
+                graf3dtiSmearing->SetUpwardSmearingBufferSize ((int)freqSmearSpectralBufferSizeUp[channel]->get());
+            
+            deferredChanges[ch] |= flags & kBaerMooreChanged;
         }
         
-        if (freqSmearEnabled[channel]->get())
-            simulator.EnableFrequencySmearing (ears[ch]);
-        else
-            simulator.DisableFrequencySmearing (ears[ch]);
+        if (flags & kEnabledChanged)
+        {
+            if (freqSmearEnabled[channel]->get())
+                simulator.EnableFrequencySmearing (ears[ch]);
+            else
+                simulator.DisableFrequencySmearing (ears[ch]);
+        }
     }
 }
 
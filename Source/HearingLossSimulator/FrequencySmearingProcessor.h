@@ -39,6 +39,11 @@ public:
     {
         for (auto const& channel : channels)
             channel->prepareToPlay (sampleRate, samplesPerBlock);
+        
+        // Setting up resets the smearers, so everything is pushed again
+        activeType[0] = activeType[1] = -1;
+        deferredChanges[0] = deferredChanges[1] = 0;
+        changedSettings = earFlags (0, kAllChanged) | earFlags (1, kAllChanged);
     }
 
     //==============================================================================
@@ -73,19 +78,68 @@ public:
     const OwnedArray<Channel>& getChannels() { return channels; }
     
     //==============================================================================
+    /** Pushes settings that changed since the last call to the simulator.
+        Called on the audio thread before each block.
+     */
     void updateSettingsIfNeeded();
     
 private:
+    //==============================================================================
+    /** Settings that changed since they were last pushed, 8 bits per ear */
+    enum ChangeFlags : uint32
+    {
+        kEnabledChanged         = 1 << 0,
+        kTypeChanged            = 1 << 1,
+        kBroadFactorUpChanged   = 1 << 2,
+        kBroadFactorDownChanged = 1 << 3,
+        kFrequencyDownChanged   = 1 << 4,
+        kFrequencyUpChanged     = 1 << 5,
+        kBufferSizeDownChanged  = 1 << 6,
+        kBufferSizeUpChanged    = 1 << 7,
+        
+        kBaerMooreChanged = kBroadFactorUpChanged | kBroadFactorDownChanged,
+        kGraf3dtiChanged  = kFrequencyDownChanged | kFrequencyUpChanged | kBufferSizeDownChanged | kBufferSizeUpChanged,
+        kAllChanged       = 0xff
+    };
+    
+    static constexpr uint32 earFlags (int ear, uint32 flags) { return flags << (8 * ear); }
+    
+    /** Raises flags in a change mask whenever a parameter changes */
+    struct ChangeListener  : private AudioProcessorParameter::Listener
+    {
+        ChangeListener (AudioProcessorParameter& p, std::atomic<uint32>& m, uint32 f)
+          : parameter (p), mask (m), flags (f)
+        {
+            parameter.addListener (this);
+        }
+        
+        ~ChangeListener() override
+        {
+            parameter.removeListener (this);
+        }
+        
+        void parameterValueChanged (int, float) override { mask.fetch_or (flags); }
+        void parameterGestureChanged (int, bool) override {}
+        
+        AudioProcessorParameter& parameter;
+        std::atomic<uint32>&     mask;
+        const uint32             flags;
+    };
     
+    void listenForChanges (AudioProcessorParameter* parameter, int ear, uint32 flags);
+    
+    //==============================================================================
     CHearingLossSim& simulator;
     
     OwnedArray<Channel> channels;
     
-    float previousSpectralBroadFactorUp[2]   = {1.01f, 1.01f};
-    float previousSpectralBroadFactorDown[2] = {1.01f, 1.01f};
+    std::atomic<uint32> changedSettings { 0 };
+    
+    // Changes for the smearer type that isn't active, pushed once it's selected
+    uint32 deferredChanges[2] = {0, 0};
+    
+    // The smearer type currently handed to the simulator, -1 if none
+    int activeType[2] = {-1, -1};
     
-    float previousSpectralFrequencyDown[2];
-    float previousSpectralFrequencyUp[2];
-    float previousSpectralBufferSizeDown[2];
-    float previousSpectralBufferSizeUp[2];
+    OwnedArray<ChangeListener> changeListeners;
 };
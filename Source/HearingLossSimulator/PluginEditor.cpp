@@ -29,7 +29,8 @@ HLSPluginAudioProcessorEditor::HLSPluginAudioProcessorEditor (HLSPluginAudioProc
     channelSwitchComponent (p),
     nonLinearAttenuatorComponent (p),
     temporalDistortionComponent (p),
-    frequencySmearingComponent (p)
+    frequencySmearingComponent (p),
+    refreshScheduler (*this, [this] { updateGui(); })
 {
     aboutText.setMultiLine(true);
     aboutText.setFont(Font(16.0f, Font::plain));
@@ -56,16 +57,13 @@ HLSPluginAudioProcessorEditor::HLSPluginAudioProcessorEditor (HLSPluginAudioProc
     addChildComponent (aboutText);
     
     setSize (800, 800);
-    
-    startTimer (30);
 }
 
 HLSPluginAudioProcessorEditor::~HLSPluginAudioProcessorEditor() {
     audiogramComponent->removeListener (this);
-    stopTimer();
 }
 
-void HLSPluginAudioProcessorEditor::timerCallback()
+void HLSPluginAudioProcessorEditor::updateGui()
 {
     channelSwitchComponent.updateGUIState();
     
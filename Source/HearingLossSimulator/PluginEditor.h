@@ -28,11 +28,12 @@
 #include "FrequencySmearingComponent.h"
 #include "Common/AboutBanner.h"
 #include "Common/AudiogramComponent.h"
+#include "Common/RefreshScheduler.h"
 
 //==============================================================================
 /**
  */
-class HLSPluginAudioProcessorEditor : public AudioProcessorEditor, public Timer, public AudiogramComponent::Listener {
+class HLSPluginAudioProcessorEditor : public AudioProcessorEditor, public AudiogramComponent::Listener {
 public:
     HLSPluginAudioProcessorEditor (HLSPluginAudioProcessor&);
     ~HLSPluginAudioProcessorEditor();
@@ -41,7 +42,7 @@ public:
     void paint (Graphics&) override;
     void resized() override;
     
-    void timerCallback() override;
+    void updateGui();
     
     void mouseUp (const MouseEvent &e) override {
         aboutText.setVisible(false);
@@ -63,5 +64,7 @@ private:
     TemporalDistortionComponent temporalDistortionComponent;
     FrequencySmearingComponent frequencySmearingComponent;
     
+    RefreshScheduler refreshScheduler;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HLSPluginAudioProcessorEditor)
 };
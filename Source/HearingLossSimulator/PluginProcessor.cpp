@@ -21,12 +21,15 @@
 #include <HAHLSimulation/ButterworthMultibandExpander.h>
 #include <HAHLSimulation/GammatoneMultibandExpander.h>
 #include "Common/Constants.h"
+#include "Common/PluginState.h"
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
 #define NUM_BANDS Constants::NUM_BANDS
 static constexpr int kINTERNAL_BLOCK_SIZE = 512;
 
+static const Identifier kStateType ("3DTI Hearing Loss Simulator Parameters");
+
 static Common::T_ear ears[2] = {Common::T_ear::LEFT, Common::T_ear::RIGHT};
 
 
@@ -231,15 +234,15 @@ void HLSPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     scratchBuffer.setSize (maxChannels, blockSizeInternal);
     
     simulator.Setup ((int)sampleRate, 100, NUM_BANDS, blockSizeInternal);
-
-    // Set up multiband expanders
-    for (int i = 0; i < getTotalNumOutputChannels(); i++)
-        setMultiBandExpander (i, MultibandExpanderType::Butterworth);
     
+    // Set up multiband expanders. Both types are built up front so that
+    // switching between them never allocates on the audio thread
     // TODO: Move into dedicated class
     butterWorthExpanders.clear();
     gammatoneExpanders.clear();
     
+    warmUpBuffer.assign (blockSizeInternal, 0.0f);
+    
     for (int i = 0; i < getTotalNumOutputChannels(); i++)
     {
         auto butterWorthExpander = shared_ptr<CButterworthMultibandExpander> (new CButterworthMultibandExpander);
@@ -252,6 +255,14 @@ void HLSPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
         vector<float> bandLimits = { 88.3883476483184f,    176.776695296637f,    353.553390593274f,    707.106781186548f,    1414.21356237310f,    2828.42712474619f,    5656.85424949238f,    11313.7084989848f };
         gammatoneExpander->SetGroups(bandLimits);
         gammatoneExpanders.add (gammatoneExpander);
+        
+        // NOTE(Ragnar): Processing a block of silence just after instantiation
+        // seems to alleviate some noise & clicks when switching expander types
+        butterWorthExpander->Process (warmUpBuffer, warmUpBuffer);
+        gammatoneExpander->Process (warmUpBuffer, warmUpBuffer);
+        
+        // Hand the selected expander to the simulator on the next block
+        activeExpanderType[i] = -1;
     }
     
     frequencySmearProcessor.prepareToPlay (sampleRate, blockSizeInternal);
@@ -260,6 +271,9 @@ void HLSPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBl
     bIn.left .assign (blockSizeInternal, 0.0f);
     bIn.right.assign (blockSizeInternal, 0.0f);
     
+    bPrevIn.left .assign (blockSizeInternal, 0.0f);
+    bPrevIn.right.assign (blockSizeInternal, 0.0f);
+    
     bOut.left .assign (blockSizeInternal, 0.0f);
     bOut.right.assign (blockSizeInternal, 0.0f);
 }
@@ -349,6 +363,10 @@ void HLSPluginAudioProcessor::processBlockInternal (AudioBuffer<float>& buffer)
     
     frequencySmearProcessor.updateSettingsIfNeeded();
     
+    // Fill input buffer
+    FloatVectorOperations::copy (bIn.left .data(), buffer.getReadPointer (0), numSamples);
+    FloatVectorOperations::copy (bIn.right.data(), buffer.getReadPointer (1), numSamples);
+    
     for (int ch = 0; ch < getTotalNumOutputChannels(); ch++)
     {
         if (enableSimulation[ch]->get())
@@ -363,15 +381,32 @@ void HLSPluginAudioProcessor::processBlockInternal (AudioBuffer<float>& buffer)
         else
             simulator.DisableMultibandExpander (ears[ch]);
         
-        if (nonLinearAttenuationFilterType[channel]->get() == MultibandExpanderType::Butterworth)
-            simulator.SetMultibandExpander (ears[ch], butterWorthExpanders[ch]);
-        else
-            simulator.SetMultibandExpander (ears[ch], gammatoneExpanders[ch]);
+        int expanderType = nonLinearAttenuationFilterType[channel]->get();
+        
+        std::shared_ptr<CMultibandExpander> incomingExpander;
+        
+        if (expanderType != activeExpanderType[ch])
+        {
+            if (expanderType == MultibandExpanderType::Butterworth)
+                incomingExpander = butterWorthExpanders[ch];
+            else
+                incomingExpander = gammatoneExpanders[ch];
+            
+            // It's swapped here on the audio thread, so no lock is needed
+            simulator.SetMultibandExpander (ears[ch], incomingExpander);
+            activeExpanderType[ch] = expanderType;
+        }
         
         // Audiometry settings
         channel = (! hearingLossLink->get()) * ch;
         for (int i = 0; i < NUM_BANDS; i++)
             simulator.SetHearingLevel_dBHL (ears[ch],  i, hearingLoss[channel][i]->get());
+        
+        // Once configured, the incoming expander runs over the previous block,
+        // so its filters lead into this block instead of carrying stale state
+        // from the last time it was selected
+        if (incomingExpander != nullptr)
+            incomingExpander->Process (ch == 0 ? bPrevIn.left : bPrevIn.right, warmUpBuffer);
     }
     
     // Temporal Distortion Settings
@@ -392,20 +427,13 @@ void HLSPluginAudioProcessor::processBlockInternal (AudioBuffer<float>& buffer)
     }
     temporalDistortionSimulator->SetLeftRightNoiseSynchronicity (jitterLeftRightSynchronicity->get());
     
-    // Fill input buffer and clear output
-    for (int i = 0; i < numSamples; i++)
-    {
-        bIn.left [i] = buffer.getReadPointer (0)[i];
-        bIn.right[i] = buffer.getReadPointer (1)[i];
-    }
-    
     simulator.Process (bIn, bOut);
+    
+    // Kept for warming up an expander selected on the next block
+    std::swap (bIn, bPrevIn);
 
-    for (int i = 0; i < numSamples; i++)
-    {
-        buffer.getWritePointer (0)[i] = bOut.left[i];
-        buffer.getWritePointer (1)[i] = bOut.right[i];
-    }
+    FloatVectorOperations::copy (buffer.getWritePointer (0), bOut.left .data(), numSamples);
+    FloatVectorOperations::copy (buffer.getWritePointer (1), bOut.right.data(), numSamples);
 }
 
 //==============================================================================
@@ -422,45 +450,26 @@ AudioProcessorEditor* HLSPluginAudioProcessor::createEditor()
 //==============================================================================
 void HLSPluginAudioProcessor::getStateInformation (MemoryBlock& destData)
 {
+    PluginState::write (PluginState::fromParameters (kStateType, *this), destData);
 }
 
 void HLSPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
+    auto state = PluginState::read (data, sizeInBytes);
+    
+    if (! state.hasType (kStateType))
+        return;
+    
+    // Apply the whole state before the next block is processed
+    suspendProcessing (true);
+    PluginState::toParameters (state, *this);
+    suspendProcessing (false);
 }
 
 void HLSPluginAudioProcessor::parameterChanged(const String& parameterID, float newValue)
 {
 }
 
-void HLSPluginAudioProcessor::setMultiBandExpander (int channel, MultibandExpanderType type)
-{
-    std::shared_ptr<HAHLSimulation::CMultibandExpander> expander;
-    if (type == MultibandExpanderType::Butterworth)
-    {
-        auto butterWorthExpander = make_shared<HAHLSimulation::CButterworthMultibandExpander>();
-        butterWorthExpander->Setup ((int)getSampleRate(), HL_INITIAL_FREQ_HZ, NUM_BANDS, true);
-        butterWorthExpander->SetNumberOfFiltersPerBand (HL_FILTERS_PER_BAND);
-        expander = butterWorthExpander;
-    }
-    else
-    {
-        auto gammatoneExpander = make_shared<HAHLSimulation::CGammatoneMultibandExpander>();
-        gammatoneExpander->Setup ((int)getSampleRate(), HL_INITIAL_FREQ_HZ, NUM_BANDS, true);
-        vector<float> bandLimits = { 88.3883476483184f,    176.776695296637f,    353.553390593274f,    707.106781186548f,    1414.21356237310f,    2828.42712474619f,    5656.85424949238f,    11313.7084989848f };
-        gammatoneExpander->SetGroups(bandLimits);
-        expander = gammatoneExpander;
-    }
-    
-    // NOTE(Ragnar): Processing a block of silence just after instantiation
-    // seems to alleviate some noise & clicks when switching expander types
-    CMonoBuffer<float> silence (getBlockSize(), 0.0f);
-    expander->Process (silence, silence);
-    
-    const ScopedLock lock (getCallbackLock());
-    simulator.SetMultibandExpander (ears[channel], expander);
-    *nonLinearAttenuationFilterType[channel] = type;
-}
-
 void HLSPluginAudioProcessor::timerCallback()
 {
     // updateFrequencySmearingParametersIfNeeded();
@@ -37,6 +37,7 @@ static const std::vector<int> jitterBandLimits = {
 
 namespace HAHLSimulation
 {
+    class CMultibandExpander;
     class CButterworthMultibandExpander;
     class CGammatoneMultibandExpander;
 };
@@ -128,6 +129,7 @@ private:
     
     //==============================================================================
     Common::CEarPair<CMonoBuffer<float>>  bIn;
+    Common::CEarPair<CMonoBuffer<float>>  bPrevIn;
     Common::CEarPair<CMonoBuffer<float>>  bOut;
     
     AudioBuffer<float>     scratchBuffer;
@@ -137,8 +139,8 @@ private:
     juce::Array<shared_ptr<CButterworthMultibandExpander>> butterWorthExpanders;
     juce::Array<shared_ptr<CGammatoneMultibandExpander>>   gammatoneExpanders;
     
-    //==============================================================================
-    void setMultiBandExpander (int channel, MultibandExpanderType type);
+    int                activeExpanderType[2] = {-1, -1};
+    CMonoBuffer<float> warmUpBuffer;
     
     //==============================================================================
     void timerCallback() override;
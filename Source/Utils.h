@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <map>
 #include <unordered_map>
 #include <Common/Buffer.h>
 #include <Common/CommonDefinitions.h>
@@ -83,13 +84,65 @@ static inline bool isSofaFile(const File& file) {
   return file.getFileExtension() == ".sofa";
 }
 
+// Reading the sample rate parses the whole resource, so the result is
+// remembered for as long as the file on disk stays the same
 static inline int checkResourceSampleRate(const File& file, bool isHRTF) {
-  auto path = file.getFullPathName().toStdString();
+  struct CachedRate {
+    Time  modified;
+    int64 size;
+    int   sampleRate;
+  };
+  
+  static CriticalSection lock;
+  static std::map<String, CachedRate> cache;
+  
+  auto key      = file.getFullPathName();
+  auto modified = file.getLastModificationTime();
+  auto size     = file.getSize();
+  
+  {
+    const ScopedLock sl (lock);
+    auto it = cache.find(key);
+    if ( it != cache.end() && it->second.modified == modified && it->second.size == size ) {
+      return it->second.sampleRate;
+    }
+  }
+  
+  auto path = key.toStdString();
+  int sampleRate;
   if ( isHRTF ) {
-    return isSofaFile(file) ? HRTF::GetSampleRateFromSofa(path) : HRTF::GetSampleRateFrom3dti(path);
+    sampleRate = isSofaFile(file) ? HRTF::GetSampleRateFromSofa(path) : HRTF::GetSampleRateFrom3dti(path);
   } else {
-    return isSofaFile(file) ? BRIR::GetSampleRateFromSofa(path) : BRIR::GetSampleRateFrom3dti(path);
+    sampleRate = isSofaFile(file) ? BRIR::GetSampleRateFromSofa(path) : BRIR::GetSampleRateFrom3dti(path);
   }
+  
+  const ScopedLock sl (lock);
+  cache[key] = { modified, size, sampleRate };
+  return sampleRate;
+}
+
+// Resources have to match the rate the toolkit runs at, which is lower
+// than the host rate in 88.2, 176.4 and 192 kHz sessions
+static inline void showWrongSampleRateAlert(int fileSampleRate, int processingSampleRate) {
+  String message;
+  
+  if ( fileSampleRate > 0 )
+    message << "This file is sampled at " << fileSampleRate << " Hz, but the plugin processes audio at "
+            << processingSampleRate << " Hz in this session.\n\n";
+  
+  message << "Please select a file sampled at " << processingSampleRate << " Hz.";
+  
+  AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, "Wrong sample rate", message, "OK");
+}
+
+// Sessions can be opened on a machine that doesn't have the custom files they used
+static inline void showMissingResourceAlert(const String& type, const File& file) {
+  String message;
+  message << "The " << type << " file used by this session could not be found:\n\n"
+          << file.getFullPathName() << "\n\n"
+          << "The default " << type << " is used instead.";
+  
+  AlertWindow::showMessageBoxAsync(AlertWindow::WarningIcon, type + " not found", message, "OK");
 }
 
 //==============================================================================